@@ -0,0 +1,132 @@
+// Contention benchmark of the rigidity caches of ParallelGrounder. Threads
+// look up keys and insert them on a miss, like is_rigid does, once with a
+// std::unordered_set behind a single mutex, the design before ShardedSet, and
+// once with ShardedSet for several shard counts.
+//
+// Usage: sharded_set_bench [max threads] [operations per thread] [keys]
+
+#include "util/sharded_set.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+class MutexSet {
+public:
+  bool contains(uint64_t value) const {
+    std::lock_guard l{mutex_};
+    return set_.find(value) != set_.end();
+  }
+
+  void insert(uint64_t value) {
+    std::lock_guard l{mutex_};
+    set_.insert(value);
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_set<uint64_t> set_;
+};
+
+// xorshift64*, seeded per thread so that all designs see the same keys
+class Random {
+public:
+  explicit Random(uint64_t seed) noexcept : state_{seed * 2 + 1} {}
+
+  uint64_t next() noexcept {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 0x2545f4914f6cdd1d;
+  }
+
+private:
+  uint64_t state_;
+};
+
+// Returns the throughput in million operations per second
+template <typename Set>
+double run(Set &set, unsigned int num_threads, uint64_t num_operations,
+           uint64_t num_keys) {
+  std::atomic_uint ready = 0;
+  std::atomic_bool start = false;
+  std::atomic_uint64_t hits = 0;
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (unsigned int thread = 0; thread < num_threads; ++thread) {
+    threads.emplace_back([&, thread]() {
+      Random random{thread};
+      uint64_t thread_hits = 0;
+      ready.fetch_add(1);
+      while (!start.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (uint64_t i = 0; i < num_operations; ++i) {
+        auto key = random.next() % num_keys;
+        if (set.contains(key)) {
+          ++thread_hits;
+        } else {
+          set.insert(key);
+        }
+      }
+      hits.fetch_add(thread_hits);
+    });
+  }
+  while (ready.load() < num_threads) {
+    std::this_thread::yield();
+  }
+  auto begin = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+  std::for_each(threads.begin(), threads.end(), [](auto &t) { t.join(); });
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - begin;
+  if (hits.load() > num_operations * num_threads) {
+    std::abort();
+  }
+  return static_cast<double>(num_operations * num_threads) /
+         elapsed.count() / 1e6;
+}
+
+uint64_t parse_argument(int argc, char *argv[], int i, uint64_t fallback) {
+  return argc > i ? std::stoull(argv[i]) : fallback;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  auto max_threads = static_cast<unsigned int>(parse_argument(
+      argc, argv, 1, std::max(std::thread::hardware_concurrency(), 1u)));
+  auto num_operations = parse_argument(argc, argv, 2, 1 << 21);
+  auto num_keys = std::max(parse_argument(argc, argv, 3, 1 << 16), 1ul);
+
+  std::printf("%u hardware threads, %lu operations per thread, %lu keys\n",
+              std::thread::hardware_concurrency(), num_operations, num_keys);
+  std::printf("%8s %12s %12s %12s %12s\n", "threads", "mutex", "1 shard",
+              "16 shards", "64 shards");
+  for (unsigned int num_threads = 1; num_threads <= max_threads;
+       num_threads = num_threads < max_threads
+                         ? std::min(2 * num_threads, max_threads)
+                         : max_threads + 1) {
+    MutexSet mutex_set;
+    util::ShardedSet<uint64_t> one_shard{1};
+    util::ShardedSet<uint64_t> shards_16{16};
+    util::ShardedSet<uint64_t> shards_64{64};
+    std::printf("%8u %12.2f %12.2f %12.2f %12.2f\n", num_threads,
+                run(mutex_set, num_threads, num_operations, num_keys),
+                run(one_shard, num_threads, num_operations, num_keys),
+                run(shards_16, num_threads, num_operations, num_keys),
+                run(shards_64, num_threads, num_operations, num_keys));
+  }
+  std::printf("Throughput in million operations per second\n");
+  return 0;
+}
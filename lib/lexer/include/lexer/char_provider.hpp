@@ -6,7 +6,7 @@
 namespace lexer {
 
 struct CharProvider {
-  explicit CharProvider(char *begin, char *end) noexcept
+  explicit CharProvider(const char *begin, const char *end) noexcept
       : begin_{begin}, current_{begin}, end_{end} {}
 
   inline char get() noexcept { return *(current_ + delta_++); }
@@ -35,9 +35,9 @@ struct CharProvider {
 
 private:
   size_t delta_ = 0;
-  char *begin_ = nullptr;
-  char *current_ = nullptr;
-  char *end_ = nullptr;
+  const char *begin_ = nullptr;
+  const char *current_ = nullptr;
+  const char *end_ = nullptr;
 };
 
 } // namespace lexer
@@ -0,0 +1,333 @@
+#ifndef DFA_HPP
+#define DFA_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace lexer {
+
+namespace dfa {
+
+inline constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+struct CharSet {
+  constexpr void insert(unsigned char c) noexcept {
+    bits[c / 64] |= uint64_t{1} << (c % 64);
+  }
+
+  constexpr bool contains(unsigned char c) const noexcept {
+    return (bits[c / 64] >> (c % 64)) & 1u;
+  }
+
+  constexpr bool operator==(const CharSet &other) const noexcept {
+    for (size_t i = 0; i < bits.size(); ++i) {
+      if (bits[i] != other.bits[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr void remove(const CharSet &other) noexcept {
+    for (size_t i = 0; i < bits.size(); ++i) {
+      bits[i] &= ~other.bits[i];
+    }
+  }
+
+  template <typename Predicate>
+  static constexpr CharSet from(Predicate predicate) noexcept {
+    CharSet set;
+    for (unsigned c = 0; c < 256; ++c) {
+      if (predicate(static_cast<char>(c))) {
+        set.insert(static_cast<unsigned char>(c));
+      }
+    }
+    return set;
+  }
+
+  std::array<uint64_t, 4> bits{};
+};
+
+// Thompson automaton in which each state has at most one byte transition and
+// two epsilon transitions. Rules append their fragment starting at a state
+// without outgoing transitions and return the state in which it ends.
+template <size_t N> struct Nfa {
+  struct State {
+    CharSet chars{};
+    size_t next = npos;
+    std::array<size_t, 2> epsilon{npos, npos};
+    // Index of the rule accepted in this state
+    size_t accept = npos;
+  };
+
+  constexpr size_t add() noexcept { return size++; }
+
+  constexpr size_t add_chars(size_t from, const CharSet &chars) noexcept {
+    auto to = add();
+    states[from].chars = chars;
+    states[from].next = to;
+    return to;
+  }
+
+  constexpr void add_epsilon(size_t from, size_t to) noexcept {
+    auto &epsilon = states[from].epsilon;
+    epsilon[epsilon[0] == npos ? 0 : 1] = to;
+  }
+
+  std::array<State, N> states{};
+  size_t size = 0;
+};
+
+template <size_t N> struct StateSet {
+  constexpr void insert(size_t i) noexcept {
+    words[i / 64] |= uint64_t{1} << (i % 64);
+  }
+
+  constexpr bool contains(size_t i) const noexcept {
+    return (words[i / 64] >> (i % 64)) & 1u;
+  }
+
+  constexpr void merge(const StateSet &other) noexcept {
+    for (size_t i = 0; i < words.size(); ++i) {
+      words[i] |= other.words[i];
+    }
+  }
+
+  constexpr bool operator==(const StateSet &other) const noexcept {
+    for (size_t i = 0; i < words.size(); ++i) {
+      if (words[i] != other.words[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr size_t hash() const noexcept {
+    uint64_t h = 14695981039346656037u;
+    for (auto w : words) {
+      h = (h ^ w) * 1099511628211u;
+    }
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+
+  template <typename F> constexpr void for_each(F f) const {
+    for (size_t i = 0; i < words.size(); ++i) {
+      for (auto w = words[i]; w != 0; w &= w - 1) {
+        f(i * 64 + static_cast<size_t>(__builtin_ctzll(w)));
+      }
+    }
+  }
+
+  std::array<uint64_t, (N + 63) / 64> words{};
+};
+
+// Partition of the bytes such that bytes of the same class are contained in
+// exactly the same transition sets
+struct ByteClasses {
+  std::array<uint8_t, 256> of{};
+  std::array<unsigned char, 256> representative{};
+  size_t size = 0;
+};
+
+template <size_t N>
+constexpr ByteClasses get_byte_classes(const Nfa<N> &nfa) noexcept {
+  // Signature of each byte over the distinct transition sets
+  std::array<CharSet, N> sets{};
+  size_t num_sets = 0;
+  for (size_t s = 0; s < nfa.size; ++s) {
+    const auto &chars = nfa.states[s].chars;
+    bool known = nfa.states[s].next == npos;
+    for (size_t i = 0; i < num_sets && !known; ++i) {
+      known = sets[i] == chars;
+    }
+    if (!known) {
+      sets[num_sets++] = chars;
+    }
+  }
+  std::array<StateSet<N>, 256> signatures{};
+  for (size_t i = 0; i < num_sets; ++i) {
+    for (unsigned c = 0; c < 256; ++c) {
+      if (sets[i].contains(static_cast<unsigned char>(c))) {
+        signatures[c].insert(i);
+      }
+    }
+  }
+
+  ByteClasses classes;
+  classes.size = 0;
+  for (unsigned c = 0; c < 256; ++c) {
+    size_t k = 0;
+    while (k < classes.size &&
+           !(signatures[classes.representative[k]] == signatures[c])) {
+      ++k;
+    }
+    if (k == classes.size) {
+      classes.representative[classes.size++] = static_cast<unsigned char>(c);
+    }
+    classes.of[c] = static_cast<uint8_t>(k);
+  }
+  return classes;
+}
+
+// How a state skips bytes that lead back to itself before stepping
+enum class Scan : uint8_t {
+  None,
+  // All bytes except the listed exit bytes loop
+  Until,
+  // At least all alphanumeric bytes loop
+  Alnum
+};
+
+template <size_t NumStates, size_t NumClasses> struct Dfa {
+  static constexpr size_t dead = 0;
+  static constexpr size_t start = 1;
+
+  std::array<uint8_t, 256> classes{};
+  std::array<uint16_t, NumStates * NumClasses> transitions{};
+  // Index of the accepted rule by state
+  std::array<size_t, NumStates> accept{};
+  std::array<Scan, NumStates> scan{};
+  std::array<std::array<char, 3>, NumStates> exits{};
+  std::array<uint8_t, NumStates> num_exits{};
+
+  constexpr size_t next(size_t state, unsigned char c) const noexcept {
+    return transitions[state * NumClasses + classes[c]];
+  }
+};
+
+// Subset construction of at most Capacity states. The empty set is the dead
+// state 0 and the closure of the NFA start is state 1.
+template <size_t N, size_t Capacity, size_t NumClasses> struct Powerset {
+  static_assert(Capacity < std::numeric_limits<uint16_t>::max());
+
+  constexpr Powerset(const Nfa<N> &nfa, const ByteClasses &classes) noexcept {
+    std::array<StateSet<N>, N> closures{};
+    std::array<size_t, N> stack{};
+    for (size_t s = 0; s < nfa.size; ++s) {
+      size_t top = 0;
+      closures[s].insert(s);
+      stack[top++] = s;
+      while (top > 0) {
+        auto current = stack[--top];
+        for (auto e : nfa.states[current].epsilon) {
+          if (e != npos && !closures[s].contains(e)) {
+            closures[s].insert(e);
+            stack[top++] = e;
+          }
+        }
+      }
+    }
+
+    // Classes of the byte transition of each state
+    std::array<StateSet<NumClasses>, N> transition_classes{};
+    for (size_t s = 0; s < nfa.size; ++s) {
+      for (size_t c = 0; c < NumClasses; ++c) {
+        if (nfa.states[s].chars.contains(classes.representative[c])) {
+          transition_classes[s].insert(c);
+        }
+      }
+    }
+
+    for (auto &slot : table) {
+      slot = npos;
+    }
+    find_or_add(StateSet<N>{});
+    find_or_add(closures[0]);
+
+    for (size_t i = 1; i < size && i < Capacity; ++i) {
+      std::array<StateSet<N>, NumClasses> targets{};
+      sets[i].for_each([&](size_t s) {
+        transition_classes[s].for_each([&](size_t c) {
+          targets[c].merge(closures[nfa.states[s].next]);
+        });
+      });
+      for (size_t c = 0; c < NumClasses; ++c) {
+        transitions[i * NumClasses + c] =
+            static_cast<uint16_t>(find_or_add(targets[c]));
+      }
+    }
+  }
+
+  constexpr size_t find_or_add(const StateSet<N> &set) noexcept {
+    auto slot = set.hash() % table.size();
+    while (table[slot] != npos) {
+      if (sets[table[slot]] == set) {
+        return table[slot];
+      }
+      slot = (slot + 1) % table.size();
+    }
+    if (size < Capacity) {
+      sets[size] = set;
+      table[slot] = size;
+    }
+    return size++;
+  }
+
+  std::array<StateSet<N>, Capacity> sets{};
+  std::array<size_t, 2 * Capacity> table{};
+  std::array<uint16_t, Capacity * NumClasses> transitions{};
+  // Exceeds the capacity if the construction was incomplete
+  size_t size = 0;
+};
+
+template <size_t NumStates, size_t N, size_t Capacity, size_t NumClasses>
+constexpr Dfa<NumStates, NumClasses>
+determinize(const Nfa<N> &nfa, const ByteClasses &classes,
+            const Powerset<N, Capacity, NumClasses> &powerset) noexcept {
+  static_assert(NumStates <= Capacity);
+  Dfa<NumStates, NumClasses> dfa;
+  dfa.classes = classes.of;
+  for (size_t i = 0; i < dfa.transitions.size(); ++i) {
+    dfa.transitions[i] = powerset.transitions[i];
+  }
+  for (size_t i = 0; i < NumStates; ++i) {
+    dfa.accept[i] = npos;
+    powerset.sets[i].for_each([&](size_t s) {
+      dfa.accept[i] = std::min(dfa.accept[i], nfa.states[s].accept);
+    });
+  }
+
+  std::array<size_t, NumClasses> class_sizes{};
+  for (auto c : classes.of) {
+    ++class_sizes[c];
+  }
+  for (size_t i = 1; i < NumStates; ++i) {
+    auto exits = [&dfa, i](unsigned char c) { return dfa.next(i, c) != i; };
+    size_t num_exits = 0;
+    for (size_t c = 0; c < NumClasses; ++c) {
+      if (dfa.transitions[i * NumClasses + c] != i) {
+        num_exits += class_sizes[c];
+      }
+    }
+    if (num_exits <= dfa.exits[i].size()) {
+      dfa.scan[i] = Scan::Until;
+      dfa.num_exits[i] = static_cast<uint8_t>(num_exits);
+      size_t k = 0;
+      for (unsigned c = 0; c < 256 && k < num_exits; ++c) {
+        if (exits(static_cast<unsigned char>(c))) {
+          dfa.exits[i][k++] = static_cast<char>(c);
+        }
+      }
+      continue;
+    }
+    bool alnum = true;
+    for (auto [first, last] : {std::pair{'0', '9'}, std::pair{'a', 'z'},
+                               std::pair{'A', 'Z'}}) {
+      for (auto c = first; c <= last; ++c) {
+        alnum &= !exits(static_cast<unsigned char>(c));
+      }
+    }
+    dfa.scan[i] = alnum ? Scan::Alnum : Scan::None;
+  }
+  return dfa;
+}
+
+} // namespace dfa
+
+} // namespace lexer
+
+#endif /* end of include guard: DFA_HPP */
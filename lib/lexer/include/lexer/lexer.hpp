@@ -7,12 +7,14 @@
 #include "lexer/literal_class.hpp"
 #include "lexer/location.hpp"
 #include "lexer/rules.hpp"
+#include "lexer/scan.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace lexer {
@@ -25,10 +27,11 @@ template <typename, typename, typename = void>
 struct has_action : std::false_type {};
 
 template <typename Token, typename Action>
-struct has_action<Token, Action,
-                  std::void_t<decltype(Action::apply(std::declval<char *>(),
-                                                     std::declval<char *>(),
-                                                     std::declval<Token>()))>>
+struct has_action<
+    Token, Action,
+    std::void_t<decltype(std::declval<Action &>().apply(
+        std::declval<const char *>(), std::declval<const char *>(),
+        std::declval<Token>()))>>
     : std::true_type {};
 
 template <typename Token, typename Action>
@@ -42,14 +45,17 @@ class Lexer {
 public:
   using Token = typename RuleSet::Token;
 
-  explicit Lexer(std::string_view name, char *begin, char *end)
+  explicit Lexer(std::string_view name, const char *begin, const char *end)
       : location_{name}, begin_{begin}, current_{begin}, end_{end} {
     get_next_token();
   }
 
   explicit Lexer() noexcept : Lexer{"", nullptr, nullptr} {}
 
-  void set_source(std::string_view name, char *begin, char *end) {
+  // Actions may keep state such as a symbol table
+  void set_action(Action action) { action_ = std::move(action); }
+
+  void set_source(std::string_view name, const char *begin, const char *end) {
     location_ = Location{name};
     begin_ = begin;
     current_ = begin;
@@ -78,18 +84,16 @@ public:
 
 private:
   void get_next_token() {
-    // Skip blanks
-    while (current_ != end_) {
-      char current_char = *current_;
-      if (LiteralClass::blank(current_char)) {
-        location_.advance_column();
-      } else if (LiteralClass::newline(current_char)) {
-        location_.advance_line();
-      } else {
-        break;
-      }
-      ++current_;
+    // Skip blanks and newlines
+    unsigned int lines = 0;
+    const char *line_begin = current_;
+    auto blanks_end = scan::skip_space(current_, end_, lines, line_begin);
+    if (lines > 0) {
+      location_.advance_line(lines);
+      current_ = line_begin;
     }
+    location_.advance_column(static_cast<unsigned int>(blanks_end - current_));
+    current_ = blanks_end;
     location_.step();
 
     token_ = ErrorToken{};
@@ -99,22 +103,13 @@ private:
       return;
     }
 
-    char *token_end = end_;
-    if (Traits::end_at_newline || Traits::end_at_blank) {
-      token_end = std::find_if(current_, end_, [](char c) {
-        return (Traits::end_at_newline && LiteralClass::newline(c)) ||
-               (Traits::end_at_blank && LiteralClass::blank(c));
-      });
-    }
-
-    CharProvider provider{current_, token_end};
-    auto result = RuleSet::match(provider);
+    auto result = RuleSet::template match<Traits>(current_, end_);
     auto next = current_ + (result.end - result.begin);
 
     std::visit(
         [this, next](auto &t) {
           if constexpr (detail::has_action_v<decltype(t), Action>) {
-            Action::apply(current_, next, t);
+            action_.apply(current_, next, t);
           }
         },
         result.token);
@@ -131,6 +126,10 @@ private:
       throw LexerException(location_ + 1, std::move(ss).str());
     }
     token_ = std::move(result.token);
+    if constexpr (Traits::end_at_newline) {
+      location_.advance_column(static_cast<unsigned int>(next - current_));
+      current_ = next;
+    }
     while (current_ != next) {
       location_.advance_column();
       if (LiteralClass::newline(*current_)) {
@@ -141,10 +140,11 @@ private:
   }
 
   Token token_ = ErrorToken{};
+  Action action_{};
   Location location_;
-  char *begin_ = nullptr;
-  char *current_ = nullptr;
-  char *end_ = nullptr;
+  const char *begin_ = nullptr;
+  const char *current_ = nullptr;
+  const char *end_ = nullptr;
 };
 
 } // namespace lexer
@@ -2,6 +2,7 @@
 #define RULES_HPP
 
 #include "lexer/char_provider.hpp"
+#include "lexer/dfa.hpp"
 #include "lexer/literal_class.hpp"
 #include "lexer/token.hpp"
 
@@ -35,6 +36,13 @@ struct basic_rule : basic_token {};
 struct Empty : basic_rule {
   static constexpr bool match(CharProvider &) noexcept { return true; }
 
+  static constexpr size_t num_states = 0;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &, size_t from) noexcept {
+    return from;
+  }
+
   static constexpr auto printable_name = "<empty>";
 };
 
@@ -48,6 +56,14 @@ template <char c> struct Literal : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from,
+                         dfa::CharSet::from([](char x) { return x == c; }));
+  }
+
   static constexpr auto printable_name = "<literal>";
 };
 
@@ -62,6 +78,15 @@ template <char c> struct ILiteral : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from([](char x) {
+      return detail::to_lower(x) == detail::to_lower(c);
+    }));
+  }
+
   static constexpr auto printable_name = "<i_literal>";
 };
 
@@ -75,6 +100,13 @@ struct Whitespace : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::blank));
+  }
+
   static constexpr auto printable_name = "<whitespace>";
 };
 
@@ -88,6 +120,13 @@ struct Digit : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::digit));
+  }
+
   static constexpr auto printable_name = "<digit>";
 };
 
@@ -101,6 +140,13 @@ struct UpperCase : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::upper));
+  }
+
   static constexpr auto printable_name = "<uppercase>";
 };
 
@@ -114,6 +160,13 @@ struct LowerCase : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::lower));
+  }
+
   static constexpr auto printable_name = "<lowercase>";
 };
 
@@ -127,6 +180,13 @@ struct Alpha : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::alpha));
+  }
+
   static constexpr auto printable_name = "<alpha>";
 };
 
@@ -140,6 +200,13 @@ struct Alnum : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(LiteralClass::alnum));
+  }
+
   static constexpr auto printable_name = "<alnum>";
 };
 
@@ -153,6 +220,13 @@ template <typename Predicate> struct LiteralIf : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    return nfa.add_chars(from, dfa::CharSet::from(Predicate{}));
+  }
+
   static constexpr auto printable_name = "<literalif>";
 };
 
@@ -168,6 +242,14 @@ template <char... cs> struct Word : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = sizeof...(cs);
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    ((from = Literal<cs>::build(nfa, from)), ...);
+    return from;
+  }
+
   static constexpr auto printable_name = "<word>";
 };
 
@@ -183,6 +265,14 @@ template <char... cs> struct IWord : basic_rule {
     return false;
   }
 
+  static constexpr size_t num_states = sizeof...(cs);
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    ((from = ILiteral<cs>::build(nfa, from)), ...);
+    return from;
+  }
+
   static constexpr auto printable_name = "<i_word>";
 };
 
@@ -196,6 +286,17 @@ template <size_t N> struct Any : basic_rule {
     return true;
   }
 
+  static constexpr size_t num_states = N;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    auto any = dfa::CharSet::from([](char) { return true; });
+    for (size_t i = 0; i < N; ++i) {
+      from = nfa.add_chars(from, any);
+    }
+    return from;
+  }
+
   static constexpr auto printable_name = "<any>";
 };
 
@@ -204,6 +305,18 @@ template <typename Rule> struct Optional : basic_rule {
     Rule::match(provider);
     return true;
   }
+
+  static constexpr size_t num_states = Rule::num_states + 1;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    auto begin = nfa.add();
+    auto end = Rule::build(nfa, begin);
+    nfa.add_epsilon(from, begin);
+    nfa.add_epsilon(from, end);
+    return end;
+  }
+
   static constexpr auto printable_name = "<optional>";
 };
 
@@ -217,6 +330,14 @@ template <typename... Rules> struct Sequence : basic_rule {
     return result;
   }
 
+  static constexpr size_t num_states = (Rules::num_states + ... + 0);
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    ((from = Rules::build(nfa, from)), ...);
+    return from;
+  }
+
   static constexpr auto printable_name = "<sequence>";
 };
 
@@ -225,6 +346,26 @@ template <typename... Rules> struct Choice : basic_rule {
     return (Rules::match(provider) || ...);
   }
 
+  static constexpr size_t num_states =
+      (Rules::num_states + ... + 0) + 2 * sizeof...(Rules) + 1;
+
+  // Each alternative branches off a chain of split states
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    auto end = nfa.add();
+    (
+        [&nfa, &from, end]() {
+          auto begin = nfa.add();
+          auto split = nfa.add();
+          nfa.add_epsilon(from, begin);
+          nfa.add_epsilon(from, split);
+          nfa.add_epsilon(Rules::build(nfa, begin), end);
+          from = split;
+        }(),
+        ...);
+    return end;
+  }
+
   static constexpr auto printable_name = "<choice>";
 };
 
@@ -235,6 +376,18 @@ template <typename Rule> struct Star : basic_rule {
     return true;
   }
 
+  static constexpr size_t num_states = Rule::num_states + 2;
+
+  template <typename Automaton>
+  static constexpr size_t build(Automaton &nfa, size_t from) noexcept {
+    auto begin = nfa.add();
+    auto end = nfa.add();
+    nfa.add_epsilon(from, begin);
+    nfa.add_epsilon(from, end);
+    nfa.add_epsilon(Rule::build(nfa, begin), from);
+    return end;
+  }
+
   static constexpr auto printable_name = "<star>";
 };
 
@@ -0,0 +1,138 @@
+#ifndef SCAN_HPP
+#define SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace lexer {
+
+namespace scan {
+
+// Returns the first byte that is neither a blank nor a newline. Counts the
+// newlines on the way and sets line_begin behind the last one.
+inline const char *skip_space(const char *begin, const char *end,
+                              unsigned int &lines,
+                              const char *&line_begin) noexcept {
+  auto current = begin;
+#ifdef __SSE2__
+  const auto space = _mm_set1_epi8(' ');
+  const auto tab = _mm_set1_epi8('\t');
+  const auto lf = _mm_set1_epi8('\n');
+  const auto cr = _mm_set1_epi8('\r');
+  while (end - current >= 16) {
+    auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+    auto newline =
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, lf), _mm_cmpeq_epi8(chunk, cr));
+    auto blank = _mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                              _mm_cmpeq_epi8(chunk, tab));
+    auto newline_mask = static_cast<unsigned>(_mm_movemask_epi8(newline));
+    auto stop_mask = ~static_cast<unsigned>(
+                         _mm_movemask_epi8(_mm_or_si128(newline, blank))) &
+                     0xFFFFu;
+    unsigned length = 16;
+    if (stop_mask != 0) {
+      length = static_cast<unsigned>(__builtin_ctz(stop_mask));
+      newline_mask &= (1u << length) - 1;
+    }
+    if (newline_mask != 0) {
+      lines += static_cast<unsigned>(__builtin_popcount(newline_mask));
+      line_begin = current + 32 - __builtin_clz(newline_mask);
+    }
+    current += length;
+    if (length < 16) {
+      return current;
+    }
+  }
+#endif
+  for (; current != end; ++current) {
+    if (*current == '\n' || *current == '\r') {
+      ++lines;
+      line_begin = current + 1;
+    } else if (*current != ' ' && *current != '\t') {
+      break;
+    }
+  }
+  return current;
+}
+
+// Returns the first occurrence of one of the first num_bytes bytes
+inline const char *find_any(const char *begin, const char *end,
+                            const char *bytes, size_t num_bytes) noexcept {
+  if (num_bytes == 0) {
+    return end;
+  }
+  auto current = begin;
+#ifdef __SSE2__
+  // Unused slots repeat the first byte
+  const auto b0 = _mm_set1_epi8(bytes[0]);
+  const auto b1 = _mm_set1_epi8(bytes[num_bytes > 1 ? 1 : 0]);
+  const auto b2 = _mm_set1_epi8(bytes[num_bytes > 2 ? 2 : 0]);
+  while (end - current >= 16) {
+    auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+    auto found = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, b0), _mm_cmpeq_epi8(chunk, b1)),
+        _mm_cmpeq_epi8(chunk, b2));
+    if (auto mask = _mm_movemask_epi8(found); mask != 0) {
+      return current + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    current += 16;
+  }
+#endif
+  for (; current != end; ++current) {
+    for (size_t i = 0; i < num_bytes; ++i) {
+      if (*current == bytes[i]) {
+        return current;
+      }
+    }
+  }
+  return current;
+}
+
+// Returns the first byte that is not alphanumeric
+inline const char *skip_alnum(const char *begin, const char *end) noexcept {
+  auto current = begin;
+#ifdef __SSE2__
+  // Signed comparisons against bounds shifted by one to get inclusive ranges
+  const auto case_bit = _mm_set1_epi8(0x20);
+  const auto before_a = _mm_set1_epi8('a' - 1);
+  const auto after_z = _mm_set1_epi8('z' + 1);
+  const auto before_0 = _mm_set1_epi8('0' - 1);
+  const auto after_9 = _mm_set1_epi8('9' + 1);
+  while (end - current >= 16) {
+    auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(current));
+    auto lower = _mm_or_si128(chunk, case_bit);
+    auto alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                               _mm_cmplt_epi8(lower, after_z));
+    auto digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, before_0),
+                               _mm_cmplt_epi8(chunk, after_9));
+    auto mask = ~static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_or_si128(alpha, digit))) &
+                0xFFFFu;
+    if (mask != 0) {
+      return current + __builtin_ctz(mask);
+    }
+    current += 16;
+  }
+#endif
+  for (; current != end; ++current) {
+    auto c = *current;
+    auto lower = static_cast<char>(c | 0x20);
+    if (!('a' <= lower && lower <= 'z') && !('0' <= c && c <= '9')) {
+      break;
+    }
+  }
+  return current;
+}
+
+} // namespace scan
+
+} // namespace lexer
+
+#endif /* end of include guard: SCAN_HPP */
@@ -2,12 +2,40 @@
 #define TOKEN_SET_HPP
 
 #include "lexer/char_provider.hpp"
+#include "lexer/dfa.hpp"
+#include "lexer/literal_class.hpp"
+#include "lexer/scan.hpp"
 #include "lexer/token.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 #include <variant>
 
 namespace lexer {
 
+namespace detail {
+
+template <typename, typename = void> struct is_regular : std::false_type {};
+
+template <typename Rule>
+struct is_regular<Rule, std::void_t<decltype(Rule::num_states)>>
+    : std::true_type {};
+
+template <typename Rule> constexpr size_t get_num_states() noexcept {
+  if constexpr (is_regular<Rule>::value) {
+    return Rule::num_states;
+  } else {
+    return 0;
+  }
+}
+
+} // namespace detail
+
+// Matches the longest token, preferring earlier rules on ties. If all rules
+// are regular, they are compiled into a single DFA at compile time.
 template <typename... Rules> struct TokenSet {
   using Token = std::variant<ErrorToken, Rules..., EndToken>;
   struct MatchResult {
@@ -16,7 +44,26 @@ template <typename... Rules> struct TokenSet {
     size_t end = 0;
   };
 
-  static MatchResult match(CharProvider &provider) noexcept {
+  static constexpr bool regular = (detail::is_regular<Rules>::value && ...);
+
+  template <typename Traits>
+  static MatchResult match(const char *begin, const char *end) noexcept {
+    if constexpr (regular) {
+      return match_dfa<Traits>(begin, end);
+    } else {
+      if (Traits::end_at_newline || Traits::end_at_blank) {
+        end = std::find_if(begin, end, [](char c) {
+          return (Traits::end_at_newline && LiteralClass::newline(c)) ||
+                 (Traits::end_at_blank && LiteralClass::blank(c));
+        });
+      }
+      CharProvider provider{begin, end};
+      return match_rules(provider);
+    }
+  }
+
+private:
+  static MatchResult match_rules(CharProvider &provider) noexcept {
     MatchResult result{};
     result.begin = provider.get_pos();
     result.end = provider.get_pos();
@@ -34,6 +81,102 @@ template <typename... Rules> struct TokenSet {
         ...);
     return result;
   }
+
+  static constexpr size_t num_nfa_states =
+      (detail::get_num_states<Rules>() + ... + 0) + 2 * sizeof...(Rules) + 1;
+
+  // Bytes that end every token
+  template <typename Traits> static constexpr dfa::CharSet get_stops() {
+    return dfa::CharSet::from([](char c) {
+      return (Traits::end_at_newline && LiteralClass::newline(c)) ||
+             (Traits::end_at_blank && LiteralClass::blank(c));
+    });
+  }
+
+  template <typename Traits>
+  static constexpr dfa::Nfa<num_nfa_states> build_nfa() noexcept {
+    dfa::Nfa<num_nfa_states> nfa;
+    size_t index = 0;
+    size_t from = nfa.add();
+    (
+        [&nfa, &index, &from]() {
+          auto begin = nfa.add();
+          auto split = nfa.add();
+          nfa.add_epsilon(from, begin);
+          nfa.add_epsilon(from, split);
+          nfa.states[Rules::build(nfa, begin)].accept = index++;
+          from = split;
+        }(),
+        ...);
+    for (size_t s = 0; s < nfa.size; ++s) {
+      nfa.states[s].chars.remove(get_stops<Traits>());
+    }
+    return nfa;
+  }
+
+  template <typename Traits> struct Automaton {
+    static constexpr auto nfa = build_nfa<Traits>();
+    static constexpr auto classes = dfa::get_byte_classes(nfa);
+    static constexpr size_t capacity = 2 * num_nfa_states;
+    static constexpr auto powerset =
+        dfa::Powerset<num_nfa_states, capacity, classes.size>{nfa, classes};
+    static_assert(powerset.size <= capacity,
+                  "Token set has too many DFA states");
+    static constexpr auto table =
+        dfa::determinize<std::min(powerset.size, capacity)>(nfa, classes,
+                                                            powerset);
+  };
+
+  template <size_t I> static Token make_token() noexcept {
+    return Token{std::in_place_index<I + 1>};
+  }
+
+  template <size_t... Is>
+  static constexpr std::array<Token (*)(), sizeof...(Is)>
+  get_token_makers(std::index_sequence<Is...>) noexcept {
+    return {&make_token<Is>...};
+  }
+
+  template <typename Traits>
+  static MatchResult match_dfa(const char *begin, const char *end) noexcept {
+    static constexpr auto makers =
+        get_token_makers(std::index_sequence_for<Rules...>{});
+    const auto &table = Automaton<Traits>::table;
+
+    MatchResult result{};
+    auto state = table.start;
+    auto rule = dfa::npos;
+    auto current = begin;
+    while (true) {
+      switch (table.scan[state]) {
+      case dfa::Scan::Until:
+        current = scan::find_any(current, end, table.exits[state].data(),
+                                 table.num_exits[state]);
+        break;
+      case dfa::Scan::Alnum:
+        current = scan::skip_alnum(current, end);
+        break;
+      case dfa::Scan::None:
+        break;
+      }
+      if (table.accept[state] != dfa::npos && current != begin) {
+        rule = table.accept[state];
+        result.end = static_cast<size_t>(current - begin);
+      }
+      if (current == end) {
+        break;
+      }
+      state = table.next(state, static_cast<unsigned char>(*current));
+      if (state == table.dead) {
+        break;
+      }
+      ++current;
+    }
+    if (rule != dfa::npos) {
+      result.token = makers[rule]();
+    }
+    return result;
+  }
 };
 
 } // namespace lexer
@@ -3,8 +3,11 @@
 
 #include "util/combination_iterator.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <cstdio>
+#include <iterator>
 #include <type_traits>
 #include <vector>
 
@@ -13,6 +16,68 @@ namespace sat {
 inline constexpr struct end_clause_t {
 } EndClause;
 
+enum class AtMostOneEncoding {
+  Auto,
+  Pairwise,
+  Sequential,
+  Ladder,
+  Commander,
+  Bimander
+};
+
+struct AtMostOneSize {
+  uint_fast64_t num_clauses = 0;
+  uint_fast64_t num_vars = 0;
+};
+
+// Number of clauses and auxiliary variables of Formula::at_most_one for a
+// group of the given size
+inline AtMostOneSize get_at_most_one_size(size_t group_size,
+                                          AtMostOneEncoding encoding) noexcept {
+  auto pairwise = [](size_t n) {
+    return AtMostOneSize{n * (n > 0 ? n - 1 : 0) / 2, 0};
+  };
+  if (encoding == AtMostOneEncoding::Auto) {
+    encoding = group_size < 8 ? AtMostOneEncoding::Pairwise
+                              : AtMostOneEncoding::Sequential;
+  }
+  if (group_size < 2) {
+    return AtMostOneSize{};
+  }
+  switch (encoding) {
+  case AtMostOneEncoding::Sequential:
+  case AtMostOneEncoding::Ladder:
+    return AtMostOneSize{3 * group_size - 4, group_size - 1};
+  case AtMostOneEncoding::Commander: {
+    AtMostOneSize size;
+    while (group_size > 4) {
+      auto num_commanders = (group_size + 2) / 3;
+      // Full groups of three have 3 pairs and 3 commander clauses
+      size.num_clauses += 6 * (group_size / 3);
+      if (group_size % 3 == 2) {
+        size.num_clauses += 3;
+      } else if (group_size % 3 == 1) {
+        size.num_clauses += 1;
+      }
+      size.num_vars += num_commanders;
+      group_size = num_commanders;
+    }
+    size.num_clauses += pairwise(group_size).num_clauses;
+    return size;
+  }
+  case AtMostOneEncoding::Bimander: {
+    auto num_groups = (group_size + 1) / 2;
+    uint_fast64_t num_bits = 0;
+    for (size_t i = 1; i < num_groups; i <<= 1) {
+      ++num_bits;
+    }
+    return AtMostOneSize{group_size / 2 + group_size * num_bits, num_bits};
+  }
+  default:
+    return pairwise(group_size);
+  }
+}
+
 template <typename Variable> struct Formula {
   struct Literal {
     constexpr explicit Literal(Variable variable, bool positive = true)
@@ -24,31 +89,118 @@ template <typename Variable> struct Formula {
     bool positive;
   };
 
-  struct Clause {
-    std::vector<Literal> literals;
+  // Non-owning view of the literals of one clause in the literal buffer
+  class Clause {
+  public:
+    Clause(const Literal *first, const Literal *last) noexcept
+        : first_{first}, last_{last} {}
+
+    inline const Literal *begin() const noexcept { return first_; }
+    inline const Literal *end() const noexcept { return last_; }
+    inline size_t size() const noexcept {
+      return static_cast<size_t>(last_ - first_);
+    }
+    inline bool empty() const noexcept { return first_ == last_; }
+    inline const Literal &operator[](size_t i) const noexcept {
+      assert(i < size());
+      return first_[i];
+    }
+
+  private:
+    const Literal *first_;
+    const Literal *last_;
+  };
+
+  class ClauseIterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Clause;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Clause *;
+    using reference = Clause;
+
+    ClauseIterator(const Formula &formula, size_t index) noexcept
+        : formula_{&formula}, index_{index} {}
+
+    inline Clause operator*() const noexcept {
+      return formula_->get_clause(index_);
+    }
+
+    ClauseIterator &operator++() noexcept {
+      ++index_;
+      return *this;
+    }
+
+    ClauseIterator operator++(int) noexcept {
+      auto old = *this;
+      ++(*this);
+      return old;
+    }
+
+    bool operator==(const ClauseIterator &other) const noexcept {
+      return index_ == other.index_;
+    }
+
+    bool operator!=(const ClauseIterator &other) const noexcept {
+      return !(*this == other);
+    }
+
+  private:
+    const Formula *formula_;
+    size_t index_;
   };
 
   Formula &operator<<(Literal literal) {
-    current_clause.literals.push_back(std::move(literal));
+    literals.push_back(std::move(literal));
     return *this;
   }
 
   Formula &operator<<(end_clause_t) {
-    clauses.push_back(std::move(current_clause));
-    current_clause.literals.clear();
+    clause_offsets.push_back(literals.size());
     return *this;
   }
 
+  inline size_t get_num_clauses() const noexcept {
+    return clause_offsets.size() - 1;
+  }
+
+  inline Clause get_clause(size_t i) const noexcept {
+    assert(i + 1 < clause_offsets.size());
+    return Clause{literals.data() + clause_offsets[i],
+                  literals.data() + clause_offsets[i + 1]};
+  }
+
+  inline ClauseIterator begin() const noexcept {
+    return ClauseIterator{*this, 0};
+  }
+
+  inline ClauseIterator end() const noexcept {
+    return ClauseIterator{*this, get_num_clauses()};
+  }
+
+  void clear() noexcept {
+    literals.clear();
+    clause_offsets.resize(1);
+  }
+
   void add_formula(const Formula &formula) {
-    clauses.insert(clauses.end(), formula.clauses.begin(),
-                   formula.clauses.end());
+    assert(literals.size() == clause_offsets.back());
+    auto offset = literals.size();
+    literals.insert(literals.end(), formula.literals.begin(),
+                    formula.literals.begin() +
+                        static_cast<std::ptrdiff_t>(
+                            formula.clause_offsets.back()));
+    clause_offsets.reserve(clause_offsets.size() + formula.get_num_clauses());
+    for (size_t i = 1; i < formula.clause_offsets.size(); ++i) {
+      clause_offsets.push_back(offset + formula.clause_offsets[i]);
+    }
   }
 
   uint_fast64_t add_dnf(const Formula &formula) {
     std::vector<size_t> list_sizes;
-    list_sizes.reserve(formula.clauses.size());
-    for (const auto &clause : formula.clauses) {
-      list_sizes.push_back(clause.literals.size());
+    list_sizes.reserve(formula.get_num_clauses());
+    for (const auto &clause : formula) {
+      list_sizes.push_back(clause.size());
     }
 
     uint_fast64_t clause_count = 0;
@@ -56,7 +208,7 @@ template <typename Variable> struct Formula {
          it != util::CombinationIterator{}; ++it) {
       const auto &combination = *it;
       for (size_t i = 0; i < combination.size(); ++i) {
-        *this << formula.clauses[i].literals[combination[i]];
+        *this << formula.get_clause(i)[combination[i]];
       }
       *this << EndClause;
       ++clause_count;
@@ -64,18 +216,160 @@ template <typename Variable> struct Formula {
     return clause_count;
   }
 
-  uint_fast64_t at_most_one(std::vector<Variable> group) {
+  uint_fast64_t at_most_one(const std::vector<Variable> &group) {
     for (size_t i = 0; i + 1 < group.size(); ++i) {
       for (size_t j = i + 1; j < group.size(); ++j) {
         *this << Literal{group[i], false} << Literal{group[j], false}
               << EndClause;
       }
     }
-    return (group.size() * group.size() > 0 ? group.size() - 1 : 0) / 2;
+    return group.size() * (group.size() > 0 ? group.size() - 1 : 0) / 2;
+  }
+
+  // Encodings other than pairwise introduce auxiliary variables, which are
+  // obtained by calling new_variable()
+  template <typename NewVariable>
+  uint_fast64_t at_most_one(const std::vector<Variable> &group,
+                            AtMostOneEncoding encoding,
+                            NewVariable &&new_variable) {
+    if (encoding == AtMostOneEncoding::Auto) {
+      // Pairwise needs n(n - 1) / 2 clauses, the sequential counter 3n - 4
+      // clauses and n - 1 variables, so it pays off from 8 variables on
+      encoding = group.size() < 8 ? AtMostOneEncoding::Pairwise
+                                  : AtMostOneEncoding::Sequential;
+    }
+    if (group.size() < 2) {
+      return 0;
+    }
+    switch (encoding) {
+    case AtMostOneEncoding::Sequential:
+      return at_most_one_sequential(group, new_variable);
+    case AtMostOneEncoding::Ladder:
+      return at_most_one_ladder(group, new_variable);
+    case AtMostOneEncoding::Commander:
+      return at_most_one_commander(group, new_variable);
+    case AtMostOneEncoding::Bimander:
+      return at_most_one_bimander(group, new_variable);
+    default:
+      return at_most_one(group);
+    }
+  }
+
+  // Sinz' sequential counter: s_i is true if one of the first i + 1 variables
+  // is true
+  template <typename NewVariable>
+  uint_fast64_t at_most_one_sequential(const std::vector<Variable> &group,
+                                       NewVariable &&new_variable) {
+    assert(group.size() >= 2);
+    auto last = new_variable();
+    *this << Literal{group[0], false} << Literal{last, true} << EndClause;
+    for (size_t i = 1; i + 1 < group.size(); ++i) {
+      auto next = new_variable();
+      *this << Literal{group[i], false} << Literal{next, true} << EndClause;
+      *this << Literal{last, false} << Literal{next, true} << EndClause;
+      *this << Literal{group[i], false} << Literal{last, false} << EndClause;
+      last = next;
+    }
+    *this << Literal{group.back(), false} << Literal{last, false} << EndClause;
+    return 3 * group.size() - 4;
+  }
+
+  // Ladder encoding of Gent and Nightingale, restricted to the implications
+  // needed for at most one: the ladder y_1 <- y_2 <- ... <- y_n-1 has its last
+  // true rung at i if x_i is true and x_i implies y_i-1 and not y_i
+  template <typename NewVariable>
+  uint_fast64_t at_most_one_ladder(const std::vector<Variable> &group,
+                                   NewVariable &&new_variable) {
+    assert(group.size() >= 2);
+    std::vector<Variable> ladder;
+    ladder.reserve(group.size() - 1);
+    for (size_t i = 0; i + 1 < group.size(); ++i) {
+      ladder.push_back(new_variable());
+    }
+    for (size_t i = 0; i + 1 < ladder.size(); ++i) {
+      *this << Literal{ladder[i + 1], false} << Literal{ladder[i], true}
+            << EndClause;
+    }
+    *this << Literal{group[0], false} << Literal{ladder[0], false}
+          << EndClause;
+    for (size_t i = 1; i + 1 < group.size(); ++i) {
+      *this << Literal{group[i], false} << Literal{ladder[i - 1], true}
+            << EndClause;
+      *this << Literal{group[i], false} << Literal{ladder[i], false}
+            << EndClause;
+    }
+    *this << Literal{group.back(), false} << Literal{ladder.back(), true}
+          << EndClause;
+    return 3 * group.size() - 4;
+  }
+
+  // Commander encoding of Klieber and Kwon: groups of three variables are
+  // pairwise constrained and each implies its commander variable, at most one
+  // of which is then recursively allowed to be true
+  template <typename NewVariable>
+  uint_fast64_t at_most_one_commander(const std::vector<Variable> &group,
+                                      NewVariable &&new_variable) {
+    constexpr size_t group_size = 3;
+    if (group.size() <= group_size + 1) {
+      return at_most_one(group);
+    }
+    uint_fast64_t clause_count = 0;
+    std::vector<Variable> commanders;
+    commanders.reserve((group.size() + group_size - 1) / group_size);
+    for (size_t first = 0; first < group.size(); first += group_size) {
+      auto last = std::min(first + group_size, group.size());
+      auto commander = new_variable();
+      for (size_t i = first; i < last; ++i) {
+        for (size_t j = i + 1; j < last; ++j) {
+          *this << Literal{group[i], false} << Literal{group[j], false}
+                << EndClause;
+          ++clause_count;
+        }
+        *this << Literal{group[i], false} << Literal{commander, true}
+              << EndClause;
+        ++clause_count;
+      }
+      commanders.push_back(commander);
+    }
+    return clause_count + at_most_one_commander(commanders, new_variable);
+  }
+
+  // Bimander encoding of Nguyen and Mai: pairs of variables are pairwise
+  // constrained and each variable implies the binary representation of its
+  // pair index
+  template <typename NewVariable>
+  uint_fast64_t at_most_one_bimander(const std::vector<Variable> &group,
+                                     NewVariable &&new_variable) {
+    constexpr size_t group_size = 2;
+    auto num_groups = (group.size() + group_size - 1) / group_size;
+    std::vector<Variable> bits;
+    for (size_t i = 1; i < num_groups; i <<= 1) {
+      bits.push_back(new_variable());
+    }
+    uint_fast64_t clause_count = 0;
+    for (size_t i = 0; i < group.size(); ++i) {
+      auto group_index = i / group_size;
+      for (size_t j = i + 1; j < std::min((group_index + 1) * group_size,
+                                          group.size());
+           ++j) {
+        *this << Literal{group[i], false} << Literal{group[j], false}
+              << EndClause;
+        ++clause_count;
+      }
+      for (size_t b = 0; b < bits.size(); ++b) {
+        *this << Literal{group[i], false}
+              << Literal{bits[b], ((group_index >> b) & 1) == 1} << EndClause;
+        ++clause_count;
+      }
+    }
+    return clause_count;
   }
 
-  Clause current_clause;
-  std::vector<Clause> clauses;
+  // The literals of clause i are literals[clause_offsets[i]] up to
+  // literals[clause_offsets[i + 1]]. Literals after the last offset belong to
+  // the clause currently being built.
+  std::vector<Literal> literals;
+  std::vector<size_t> clause_offsets{0};
 };
 
 } // namespace sat
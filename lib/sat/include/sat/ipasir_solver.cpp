@@ -24,6 +24,15 @@ void IpasirSolver::add_impl(int l) noexcept {
   num_vars_ = std::max(num_vars_, static_cast<unsigned int>(std::abs(l)));
 }
 
+void IpasirSolver::add_clauses_impl(const std::vector<int> &clauses) noexcept {
+  int max_var = 0;
+  for (auto l : clauses) {
+    ipasir_add(handle_, l);
+    max_var = std::max(max_var, std::abs(l));
+  }
+  num_vars_ = std::max(num_vars_, static_cast<unsigned int>(max_var));
+}
+
 void IpasirSolver::assume_impl(int l) noexcept { ipasir_assume(handle_, l); }
 
 Solver::Status IpasirSolver::solve_impl(util::Seconds timeout,
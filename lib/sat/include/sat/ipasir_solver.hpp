@@ -29,6 +29,7 @@ public:
 
 private:
   void add_impl(int l) noexcept override;
+  void add_clauses_impl(const std::vector<int> &clauses) noexcept override;
   void assume_impl(int l) noexcept override;
   Status solve_impl(util::Seconds timeout,
                     util::Seconds solve_timeout) noexcept override;
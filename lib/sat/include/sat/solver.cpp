@@ -13,6 +13,13 @@ Solver &Solver::add(int l) {
 
 Solver &Solver::operator<<(int l) { return add(l); }
 
+Solver &Solver::add_clauses(const std::vector<int> &clauses) {
+  assert(status_ == Status::Constructing);
+  assert(clauses.empty() || clauses.back() == 0);
+  add_clauses_impl(clauses);
+  return *this;
+}
+
 void Solver::assume(int l) {
   assert(status_ == Status::Constructing);
   assume_impl(l);
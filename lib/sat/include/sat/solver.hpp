@@ -16,6 +16,8 @@ public:
 
   Solver &add(int l);
   Solver &operator<<(int l);
+  // Adds a sequence of 0-terminated clauses at once
+  Solver &add_clauses(const std::vector<int> &clauses);
   void assume(int l);
   void solve(util::Seconds timeout, util::Seconds solve_timeout);
   Status get_status() const;
@@ -29,6 +31,7 @@ protected:
 
 private:
   virtual void add_impl(int l) = 0;
+  virtual void add_clauses_impl(const std::vector<int> &clauses) = 0;
   virtual void assume_impl(int l) = 0;
   virtual Status solve_impl(util::Seconds timeout,
                             util::Seconds solve_timeout) = 0;
@@ -3,6 +3,7 @@
 
 #include "logging/logging.hpp"
 #include "options/options.hpp"
+#include "sat/formula.hpp"
 #include "util/timer.hpp"
 
 #include <chrono>
@@ -45,8 +46,9 @@ struct Config {
     FirstEffect
   };
   enum class CachePolicy { None, NoUnsuccessful, Unsuccessful };
-  enum class PruningPolicy { Eager, Ground, Trivial };
+  enum class PruningPolicy { Eager, Ground, Trivial, Datalog };
   enum class Encoding { Sequential, Foreach, LiftedForeach, Exists };
+  enum class ParameterEncoding { Direct, Binary, Order };
   enum class Solver { Ipasir };
 
 #ifdef PARALLEL
@@ -59,6 +61,9 @@ struct Config {
   PlanningMode planning_mode = PlanningMode::Oneshot;
   util::Seconds timeout = util::inf_time;
   std::optional<std::string> plan_file = std::nullopt;
+  // Normalized problems are stored in the binary format of serialize.hpp
+  std::optional<std::string> dump_file = std::nullopt;
+  std::optional<std::string> load_file = std::nullopt;
 
   // Grounding
   ParameterSelection parameter_selection = ParameterSelection::ApproxMinNew;
@@ -70,11 +75,18 @@ struct Config {
 
   // Encoding
   Encoding encoding = Encoding::Foreach;
+  // Representation of the values of free action parameters in the lifted
+  // encodings: one variable per value, the bits of the value index or the
+  // order encoding x >= i of the value index
+  ParameterEncoding parameter_encoding = ParameterEncoding::Direct;
   bool parameter_implies_action = false;
   // Number of dnf clauses with more than 1 literal to be converted to cnf.
   // Above this limit, helper variables are introduced to mitigate a too high
   // clause count.
   unsigned int dnf_threshold = 4;
+  sat::AtMostOneEncoding at_most_one_encoding = sat::AtMostOneEncoding::Auto;
+  // Directory storing the encodings of previous runs, see EncodingCache
+  std::optional<std::string> encoding_cache = std::nullopt;
 
   // Planning
   Solver solver = Solver::Ipasir;
@@ -86,6 +98,11 @@ struct Config {
 #ifdef PARALLEL
   // Parallel
   unsigned int num_threads = 2;
+  // Number of mutex-guarded shards of each rigidity cache in the parallel
+  // grounder. A single shard serializes all threads accessing a predicate.
+  unsigned int cache_shards = 16;
+  // Threads used by each encoder to generate the clauses per ground atom
+  unsigned int encoding_threads = 1;
 #endif
 
   // Logging
@@ -128,6 +145,38 @@ struct Config {
     }
   }
 
+  void parse_parameter_encoding(const std::string &input) {
+    if (input == "direct") {
+      parameter_encoding = ParameterEncoding::Direct;
+    } else if (input == "binary") {
+      parameter_encoding = ParameterEncoding::Binary;
+    } else if (input == "order") {
+      parameter_encoding = ParameterEncoding::Order;
+    } else {
+      throw ConfigException{"Unknown parameter encoding \'" +
+                            std::string{input} + "\'"};
+    }
+  }
+
+  void parse_at_most_one_encoding(const std::string &input) {
+    if (input == "auto") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Auto;
+    } else if (input == "pairwise") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Pairwise;
+    } else if (input == "seq" || input == "sequential") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Sequential;
+    } else if (input == "ladder") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Ladder;
+    } else if (input == "commander") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Commander;
+    } else if (input == "bimander") {
+      at_most_one_encoding = sat::AtMostOneEncoding::Bimander;
+    } else {
+      throw ConfigException{"Unknown at-most-one encoding \'" +
+                            std::string{input} + "\'"};
+    }
+  }
+
   void parse_parameter_selection(const std::string &input) {
     if (input == "mostfrequent") {
       parameter_selection = ParameterSelection::MostFrequent;
@@ -167,6 +216,8 @@ struct Config {
       pruning_policy = PruningPolicy::Ground;
     } else if (input == "trivial") {
       pruning_policy = PruningPolicy::Trivial;
+    } else if (input == "datalog") {
+      pruning_policy = PruningPolicy::Datalog;
     } else {
       throw ConfigException{"Unknown pruning policy \'" + std::string{input} +
                             "\'"};
@@ -0,0 +1,202 @@
+#include "encoder/encoder.hpp"
+#include "sat/formula.hpp"
+
+#include <vector>
+
+#ifdef PARALLEL
+util::ThreadPool &Encoder::get_pool() {
+  static util::ThreadPool pool{config.encoding_threads};
+  return pool;
+}
+#endif
+
+void Encoder::encode() {
+  encode_impl();
+  init_template_ = compile(init_);
+  universal_template_ = compile(universal_clauses_);
+  transition_template_ = compile(transition_clauses_);
+  goal_template_ = compile(goal_);
+}
+
+Encoder::EncodingSize Encoder::estimate_size() const {
+  auto size = estimate_size_impl();
+  LOG_INFO(encoding_logger,
+           "Estimated variables per step: %lu, clauses per step: %lu "
+           "(%lu action, %lu implication, %lu interference, %lu frame axiom)",
+           size.num_vars, size.get_num_clauses(), size.action_clauses,
+           size.implication_clauses, size.interference_clauses,
+           size.frame_axiom_clauses);
+  return size;
+}
+
+Encoder::ClauseTemplate Encoder::compile(const Formula &formula) const {
+  ClauseTemplate clause_template;
+  auto num_literals = formula.literals.size() + formula.get_num_clauses();
+  clause_template.literals.reserve(num_literals);
+  clause_template.step_offsets.reserve(num_literals);
+  for (const auto &clause : formula) {
+    for (const auto &literal : clause) {
+      auto sat_var = to_sat_var(literal, 0);
+      clause_template.literals.push_back(sat_var);
+      clause_template.step_offsets.push_back(to_sat_var(literal, 1) - sat_var);
+    }
+    clause_template.literals.push_back(0);
+    clause_template.step_offsets.push_back(0);
+  }
+  return clause_template;
+}
+
+Encoder::ParameterVariables Encoder::init_parameter(size_t num_values) {
+  ParameterVariables parameter;
+  parameter.num_values = num_values;
+  size_t num_variables = 0;
+  switch (config.parameter_encoding) {
+  case Config::ParameterEncoding::Direct:
+    num_variables = num_values;
+    break;
+  case Config::ParameterEncoding::Binary:
+    while (num_values > (size_t{1} << num_variables)) {
+      ++num_variables;
+    }
+    break;
+  case Config::ParameterEncoding::Order:
+    num_variables = num_values > 0 ? num_values - 1 : 0;
+    break;
+  }
+  parameter.variables.reserve(num_variables);
+  for (size_t i = 0; i < num_variables; ++i) {
+    parameter.variables.push_back(num_vars_++);
+  }
+  return parameter;
+}
+
+uint_fast64_t Encoder::encode_parameter(Variable action,
+                                        const ParameterVariables &parameter) {
+  const auto &variables = parameter.variables;
+  if (parameter.num_values == 0) {
+    universal_clauses_ << Literal{action, false} << sat::EndClause;
+    return 1;
+  }
+  uint_fast64_t clause_count = 0;
+  switch (config.parameter_encoding) {
+  case Config::ParameterEncoding::Direct: {
+    std::vector<Variable> all_arguments;
+    all_arguments.reserve(variables.size());
+    universal_clauses_ << Literal{action, false};
+    for (auto variable : variables) {
+      universal_clauses_ << Literal{Variable{variable}, true};
+      all_arguments.push_back(Variable{variable});
+    }
+    universal_clauses_ << sat::EndClause;
+    ++clause_count;
+    clause_count += universal_clauses_.at_most_one(
+        all_arguments, config.at_most_one_encoding,
+        [this]() { return Variable{num_vars_++}; });
+    if (config.parameter_implies_action) {
+      for (auto argument : all_arguments) {
+        universal_clauses_ << Literal{argument, false}
+                           << Literal{action, true} << sat::EndClause;
+      }
+      clause_count += all_arguments.size();
+    }
+    break;
+  }
+  case Config::ParameterEncoding::Binary: {
+    // Exclude the values greater than the largest index m: for each bit b not
+    // set in m, the value must not agree with m on all set bits above b
+    auto max_value = parameter.num_values - 1;
+    for (size_t b = 0; b < variables.size(); ++b) {
+      if (((max_value >> b) & 1) == 1) {
+        continue;
+      }
+      universal_clauses_ << Literal{Variable{variables[b]}, false};
+      for (size_t c = b + 1; c < variables.size(); ++c) {
+        if (((max_value >> c) & 1) == 1) {
+          universal_clauses_ << Literal{Variable{variables[c]}, false};
+        }
+      }
+      universal_clauses_ << sat::EndClause;
+      ++clause_count;
+    }
+    break;
+  }
+  case Config::ParameterEncoding::Order:
+    for (size_t i = 0; i + 1 < variables.size(); ++i) {
+      universal_clauses_ << Literal{Variable{variables[i + 1]}, false}
+                         << Literal{Variable{variables[i]}, true}
+                         << sat::EndClause;
+      ++clause_count;
+    }
+    break;
+  }
+  return clause_count;
+}
+
+void Encoder::estimate_parameter(const ParameterVariables &parameter,
+                                 EncodingSize &size) const noexcept {
+  const auto &variables = parameter.variables;
+  if (parameter.num_values == 0) {
+    ++size.action_clauses;
+    return;
+  }
+  switch (config.parameter_encoding) {
+  case Config::ParameterEncoding::Direct: {
+    auto at_most_one_size = sat::get_at_most_one_size(
+        variables.size(), config.at_most_one_encoding);
+    size.action_clauses += 1 + at_most_one_size.num_clauses;
+    size.num_vars += at_most_one_size.num_vars;
+    if (config.parameter_implies_action) {
+      size.action_clauses += variables.size();
+    }
+    break;
+  }
+  case Config::ParameterEncoding::Binary: {
+    auto max_value = parameter.num_values - 1;
+    for (size_t b = 0; b < variables.size(); ++b) {
+      if (((max_value >> b) & 1) == 0) {
+        ++size.action_clauses;
+      }
+    }
+    break;
+  }
+  case Config::ParameterEncoding::Order:
+    size.action_clauses += variables.size() > 0 ? variables.size() - 1 : 0;
+    break;
+  }
+}
+
+size_t
+Encoder::get_num_parameter_literals(const ParameterVariables &parameter,
+                                    size_t value) const noexcept {
+  size_t num_literals = 0;
+  for_each_parameter_literal(parameter, value,
+                             [&num_literals](Literal) { ++num_literals; });
+  return num_literals;
+}
+
+size_t Encoder::get_parameter_value(const sat::Model &model,
+                                    const ParameterVariables &parameter,
+                                    uint_fast64_t offset) const noexcept {
+  const auto &variables = parameter.variables;
+  size_t value = 0;
+  switch (config.parameter_encoding) {
+  case Config::ParameterEncoding::Direct:
+    while (value < variables.size() && !model[variables[value] + offset]) {
+      ++value;
+    }
+    break;
+  case Config::ParameterEncoding::Binary:
+    for (size_t b = 0; b < variables.size(); ++b) {
+      if (model[variables[b] + offset]) {
+        value |= size_t{1} << b;
+      }
+    }
+    break;
+  case Config::ParameterEncoding::Order:
+    while (value < variables.size() && model[variables[value] + offset]) {
+      ++value;
+    }
+    break;
+  }
+  return value;
+}
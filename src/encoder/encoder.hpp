@@ -7,7 +7,16 @@
 #include "sat/formula.hpp"
 #include "sat/model.hpp"
 
+#include <cassert>
+#include <limits>
 #include <memory>
+#include <vector>
+
+#ifdef PARALLEL
+#include "util/thread_pool.hpp"
+
+#include <algorithm>
+#endif
 
 extern Config config;
 extern util::Timer global_timer;
@@ -27,17 +36,75 @@ public:
   static constexpr unsigned int SAT = 1;
   static constexpr unsigned int UNSAT = 2;
 
+  // Variables representing the value of a free action parameter, see
+  // Config::ParameterEncoding
+  struct ParameterVariables {
+    size_t num_values = 0;
+    std::vector<uint_fast64_t> variables;
+  };
+
+  // Variables needed to decode an action from a model. parameters has one
+  // entry per action parameter, which is empty for bound parameters.
+  struct ActionVariables {
+    uint_fast64_t sat_var;
+    std::vector<ParameterVariables> parameters;
+  };
+
+  // Predicted number of variables and clauses per step by clause family
+  struct EncodingSize {
+    uint_fast64_t num_vars = 0;
+    uint_fast64_t action_clauses = 0;
+    uint_fast64_t implication_clauses = 0;
+    uint_fast64_t interference_clauses = 0;
+    uint_fast64_t frame_axiom_clauses = 0;
+
+    uint_fast64_t get_num_clauses() const noexcept {
+      return action_clauses + implication_clauses + interference_clauses +
+             frame_axiom_clauses;
+    }
+
+    // Variables and clauses both drive the solving effort, so encodings are
+    // compared by their sum
+    uint_fast64_t get_size() const noexcept {
+      return num_vars + get_num_clauses();
+    }
+  };
+
+  // Solver-ready clauses of a formula at step 0, terminated by 0 like in
+  // ipasir. The clauses for step k are obtained by adding k * step_offsets[i]
+  // to literals[i], the offset being 0 for literals independent of the step.
+  struct ClauseTemplate {
+    void instantiate(unsigned int step, std::vector<int> &clauses) const {
+      clauses.resize(literals.size());
+      auto factor = static_cast<int>(step);
+      for (size_t i = 0; i < literals.size(); ++i) {
+        clauses[i] = literals[i] + factor * step_offsets[i];
+      }
+    }
+
+    std::vector<int> literals;
+    std::vector<int> step_offsets;
+  };
+
   explicit Encoder(const std::shared_ptr<normalized::Problem> &problem,
                    util::Seconds timeout = util::inf_time) noexcept
       : timeout_{timeout}, problem_{problem} {}
 
-  virtual void encode() = 0;
+  void encode();
+  // Predicts the size of the encoding from the supports without generating
+  // any clauses. Only valid before encode() is called.
+  EncodingSize estimate_size() const;
+  // The timeout is measured from the construction of the encoder
+  void set_timeout(util::Seconds timeout) noexcept { timeout_ = timeout; }
 
   virtual int to_sat_var(Literal l, unsigned int step) const = 0;
   virtual Plan extract_plan(const sat::Model &model,
                             unsigned int num_steps) const = 0;
+  // The variables of each action of the problem, indexed like its actions
+  virtual std::vector<ActionVariables> get_action_variables() const = 0;
 
   auto get_num_vars() const noexcept { return num_vars_; }
+  const auto &get_problem() const noexcept { return problem_; }
 
   const auto &get_init() const noexcept { return init_; }
   const auto &get_universal_clauses() const noexcept {
@@ -48,9 +115,114 @@ public:
   }
   const auto &get_goal_clauses() const noexcept { return goal_; }
 
+  const auto &get_init_template() const noexcept { return init_template_; }
+  const auto &get_universal_template() const noexcept {
+    return universal_template_;
+  }
+  const auto &get_transition_template() const noexcept {
+    return transition_template_;
+  }
+  const auto &get_goal_template() const noexcept { return goal_template_; }
+
   virtual ~Encoder() = default;
 
 protected:
+  ClauseTemplate compile(const Formula &formula) const;
+
+  ParameterVariables init_parameter(size_t num_values);
+  // Adds the clauses restricting the parameter to exactly one value if the
+  // action is executed
+  uint_fast64_t encode_parameter(Variable action,
+                                 const ParameterVariables &parameter);
+  // Adds the clauses and auxiliary variables of encode_parameter
+  void estimate_parameter(const ParameterVariables &parameter,
+                          EncodingSize &size) const noexcept;
+  size_t get_num_parameter_literals(const ParameterVariables &parameter,
+                                    size_t value) const noexcept;
+  size_t get_parameter_value(const sat::Model &model,
+                             const ParameterVariables &parameter,
+                             uint_fast64_t offset) const noexcept;
+
+  // Calls f for each literal of the conjunction stating that the parameter
+  // has the given value
+  template <typename F>
+  void for_each_parameter_literal(const ParameterVariables &parameter,
+                                  size_t value, F &&f) const {
+    assert(value < parameter.num_values);
+    const auto &variables = parameter.variables;
+    switch (config.parameter_encoding) {
+    case Config::ParameterEncoding::Direct:
+      f(Literal{Variable{variables[value]}, true});
+      break;
+    case Config::ParameterEncoding::Binary:
+      for (size_t b = 0; b < variables.size(); ++b) {
+        f(Literal{Variable{variables[b]}, ((value >> b) & 1) == 1});
+      }
+      break;
+    case Config::ParameterEncoding::Order:
+      // variables[i] is true iff the value is greater than i
+      if (value > 0) {
+        f(Literal{Variable{variables[value - 1]}, true});
+      }
+      if (value < variables.size()) {
+        f(Literal{Variable{variables[value]}, false});
+      }
+      break;
+    }
+  }
+
+  // Adds the conjunction stating that the parameter has the given value to
+  // the current clause of the formula, or the negation as disjunction if
+  // positive is false
+  void add_parameter_value(Formula &formula,
+                           const ParameterVariables &parameter, size_t value,
+                           bool positive) const {
+    for_each_parameter_literal(parameter, value, [&](Literal l) {
+      formula << (positive ? l : !l);
+    });
+  }
+
+  // Calls f(i, universal, transition, dnf) for each i in [0, num_items) and
+  // returns the sum of the results. f appends its clauses to the given
+  // formulas and may use dnf as scratch space. With multiple encoding
+  // threads, consecutive items are grouped into chunks with separate formulas
+  // that are merged in order, so the result does not depend on the number of
+  // threads. f must therefore not modify any shared state.
+  template <typename F>
+  uint_fast64_t generate_clauses(size_t num_items, F &&f) {
+#ifdef PARALLEL
+    if (config.encoding_threads > 1 && num_items > chunk_size_) {
+      auto num_chunks = (num_items + chunk_size_ - 1) / chunk_size_;
+      std::vector<Formula> universal(num_chunks);
+      std::vector<Formula> transition(num_chunks);
+      std::vector<uint_fast64_t> clause_counts(num_chunks);
+      auto &pool = get_pool();
+      std::vector<Formula> dnf(pool.get_num_threads());
+      pool.run(num_chunks, config.encoding_threads,
+               [&](size_t chunk, unsigned int thread) {
+                 auto last = std::min((chunk + 1) * chunk_size_, num_items);
+                 for (auto i = chunk * chunk_size_; i < last; ++i) {
+                   clause_counts[chunk] +=
+                       f(i, universal[chunk], transition[chunk], dnf[thread]);
+                 }
+               });
+      uint_fast64_t clause_count = 0;
+      for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+        universal_clauses_.add_formula(universal[chunk]);
+        transition_clauses_.add_formula(transition[chunk]);
+        clause_count += clause_counts[chunk];
+      }
+      return clause_count;
+    }
+#endif
+    Formula dnf;
+    uint_fast64_t clause_count = 0;
+    for (size_t i = 0; i < num_items; ++i) {
+      clause_count += f(i, universal_clauses_, transition_clauses_, dnf);
+    }
+    return clause_count;
+  }
+
   bool check_timeout() {
     return global_timer.get_elapsed_time() > config.timeout ||
            timer_.get_elapsed_time() > timeout_
@@ -67,8 +239,35 @@ protected:
   Formula universal_clauses_;
   Formula transition_clauses_;
   Formula goal_;
+  ClauseTemplate init_template_;
+  ClauseTemplate universal_template_;
+  ClauseTemplate transition_template_;
+  ClauseTemplate goal_template_;
 
   std::shared_ptr<normalized::Problem> problem_;
+
+  // Multiplies the number of clauses of a dnf by the size of another term,
+  // saturating instead of overflowing
+  static uint_fast64_t multiply_dnf_size(uint_fast64_t num_clauses,
+                                         uint_fast64_t term_size) noexcept {
+    if (term_size > 0 &&
+        num_clauses > std::numeric_limits<uint_fast64_t>::max() / term_size) {
+      return std::numeric_limits<uint_fast64_t>::max();
+    }
+    return num_clauses * term_size;
+  }
+
+private:
+#ifdef PARALLEL
+  static constexpr size_t chunk_size_ = 64;
+
+  // Workers shared by all encoders, created on first use with
+  // config.encoding_threads threads
+  static util::ThreadPool &get_pool();
+#endif
+
+  virtual void encode_impl() = 0;
+  virtual EncodingSize estimate_size_impl() const = 0;
 };
 
 #endif /* end of include guard: ENCODER_HPP */
@@ -0,0 +1,460 @@
+#include "encoder/encoding_cache.hpp"
+#include "config.hpp"
+#include "encoder/encoder.hpp"
+#include "logging/logging.hpp"
+#include "model/normalized/model.hpp"
+#include "util/mapped_file.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace normalized;
+
+namespace {
+
+// Identifies the file layout and has to be changed along with it
+constexpr uint64_t file_magic = 0x52504e4300000001;
+
+struct InvalidCacheFile {};
+
+// 64 bit FNV-1a
+class Hasher {
+public:
+  void add(uint64_t value) noexcept {
+    for (unsigned int i = 0; i < 8; ++i) {
+      add_byte(static_cast<unsigned char>(value >> (8 * i)));
+    }
+  }
+
+  void add(const std::string &s) noexcept {
+    add(s.size());
+    for (auto c : s) {
+      add_byte(static_cast<unsigned char>(c));
+    }
+  }
+
+  void add(float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(uint64_t{bits});
+  }
+
+  void add(double value) noexcept {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(bits);
+  }
+
+  void add(const Parameter &parameter) noexcept {
+    add(uint64_t{parameter.is_free()});
+    add(parameter.is_free() ? uint64_t{parameter.get_type()}
+                            : uint64_t{parameter.get_constant()});
+  }
+
+  void add(const Argument &argument) noexcept {
+    add(uint64_t{argument.is_parameter()});
+    add(argument.is_parameter() ? uint64_t{argument.get_parameter_index()}
+                                : uint64_t{argument.get_constant()});
+  }
+
+  void add(const Condition &condition) noexcept {
+    add(uint64_t{condition.atom.predicate});
+    add(condition.atom.arguments);
+    add(uint64_t{condition.positive});
+  }
+
+  void add(const std::pair<GroundAtom, bool> &atom) noexcept {
+    add(atom.first);
+    add(uint64_t{atom.second});
+  }
+
+  void add(const GroundAtom &atom) noexcept {
+    add(uint64_t{atom.predicate});
+    add(atom.arguments);
+  }
+
+  template <typename T> void add(const util::Index<T> &index) noexcept {
+    add(uint64_t{index});
+  }
+
+  template <typename T> void add(const std::vector<T> &values) noexcept {
+    add(values.size());
+    for (const auto &value : values) {
+      add(value);
+    }
+  }
+
+  template <typename T>
+  void add(const util::SharedVector<T> &values) noexcept {
+    add(values.get());
+  }
+
+  uint64_t get_hash() const noexcept { return hash_; }
+
+private:
+  void add_byte(unsigned char byte) noexcept {
+    hash_ ^= byte;
+    hash_ *= 0x100000001b3;
+  }
+
+  uint64_t hash_ = 0xcbf29ce484222325;
+};
+
+uint64_t get_key(const Problem &problem) {
+  Hasher hasher;
+  hasher.add(problem.types.size());
+  for (const auto &type : problem.types) {
+    hasher.add(type.supertype);
+  }
+  hasher.add(problem.type_names);
+  hasher.add(problem.constants.size());
+  for (const auto &constant : problem.constants) {
+    hasher.add(constant.type);
+  }
+  hasher.add(problem.constant_names);
+  hasher.add(problem.predicates.size());
+  for (const auto &predicate : problem.predicates) {
+    hasher.add(predicate.parameter_types);
+  }
+  hasher.add(problem.predicate_names);
+  hasher.add(problem.actions.size());
+  for (const auto &action : problem.actions) {
+    hasher.add(action.id);
+    hasher.add(action.parameters);
+    hasher.add(action.preconditions);
+    hasher.add(action.ground_preconditions);
+    hasher.add(action.effects);
+    hasher.add(action.ground_effects);
+  }
+  hasher.add(problem.action_names);
+  hasher.add(problem.init);
+  hasher.add(problem.goal);
+
+  hasher.add(static_cast<uint64_t>(config.planning_mode));
+  hasher.add(static_cast<uint64_t>(config.parameter_selection));
+  hasher.add(static_cast<uint64_t>(config.pruning_policy));
+  hasher.add(config.target_groundness);
+  hasher.add(uint64_t{config.granularity});
+  hasher.add(config.grounding_timeout.count());
+  hasher.add(static_cast<uint64_t>(config.encoding));
+  hasher.add(static_cast<uint64_t>(config.parameter_encoding));
+  hasher.add(uint64_t{config.parameter_implies_action});
+  hasher.add(uint64_t{config.dnf_threshold});
+  hasher.add(static_cast<uint64_t>(config.at_most_one_encoding));
+  return hasher.get_hash();
+}
+
+// Bounds checked sequential access to the words of a cache file
+class Reader {
+public:
+  explicit Reader(const util::MappedFile &file) noexcept
+      : words_{reinterpret_cast<const uint64_t *>(file.data())},
+        size_{file.size() / sizeof(uint64_t)} {}
+
+  uint64_t read() {
+    if (pos_ >= size_) {
+      throw InvalidCacheFile{};
+    }
+    return words_[pos_++];
+  }
+
+  // Reads a value not exceeding max
+  uint64_t read(uint64_t max) {
+    auto value = read();
+    if (value > max) {
+      throw InvalidCacheFile{};
+    }
+    return value;
+  }
+
+  uint64_t read_index(uint64_t num_indices) {
+    auto value = read();
+    if (value >= num_indices) {
+      throw InvalidCacheFile{};
+    }
+    return value;
+  }
+
+  size_t get_pos() const noexcept { return pos_; }
+  bool at_end() const noexcept { return pos_ == size_; }
+
+private:
+  const uint64_t *words_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+void write_formula(const Encoder::Formula &formula,
+                   std::vector<uint64_t> &words) {
+  auto num_literals = formula.clause_offsets.back();
+  words.push_back(formula.get_num_clauses());
+  words.push_back(num_literals);
+  words.insert(words.end(), formula.clause_offsets.begin(),
+               formula.clause_offsets.end());
+  for (size_t i = 0; i < num_literals; ++i) {
+    const auto &literal = formula.literals[i];
+    words.push_back((uint64_t{literal.variable.sat_var} << 2) |
+                    (uint64_t{literal.variable.this_step} << 1) |
+                    uint64_t{literal.positive});
+  }
+}
+
+void validate_formula(Reader &reader, uint64_t max_var) {
+  auto num_clauses = reader.read();
+  auto num_literals = reader.read();
+  uint64_t offset = reader.read(0);
+  for (uint64_t i = 0; i < num_clauses; ++i) {
+    auto next_offset = reader.read(num_literals);
+    if (next_offset < offset) {
+      throw InvalidCacheFile{};
+    }
+    offset = next_offset;
+  }
+  if (offset != num_literals) {
+    throw InvalidCacheFile{};
+  }
+  for (uint64_t i = 0; i < num_literals; ++i) {
+    reader.read((max_var << 2) | 3);
+  }
+}
+
+} // namespace
+
+EncodingCache::EncodingCache(
+    const std::shared_ptr<normalized::Problem> &problem)
+    : key_{get_key(*problem)}, problem_{problem} {
+  std::stringstream file;
+  file << *config.encoding_cache << '/' << std::hex << std::setw(16)
+       << std::setfill('0') << key_ << ".enc";
+  file_ = file.str();
+}
+
+std::unique_ptr<Encoder> EncodingCache::load() const {
+  util::MappedFile file{file_};
+  if (!file.is_open()) {
+    LOG_INFO(encoding_logger, "No cached encoding found");
+    return nullptr;
+  }
+  try {
+    Reader reader{file};
+    if (reader.read() != file_magic || reader.read() != key_) {
+      throw InvalidCacheFile{};
+    }
+    // Variables are numbered per step, which must fit into the solver
+    // literals for at least a few steps
+    auto num_vars = reader.read(std::numeric_limits<int>::max() / 4);
+    auto max_var = num_vars + 2;
+    auto formula_begin = reader.get_pos();
+    for (size_t i = 0; i < 4; ++i) {
+      validate_formula(reader, max_var);
+    }
+    std::vector<CachedEncoder::CachedAction> actions(
+        reader.read(file.size()));
+    for (auto &action : actions) {
+      action.id = reader.read_index(problem_->actions.size());
+      action.variables.sat_var = reader.read(max_var);
+      auto num_parameters =
+          reader.read(problem_->actions[action.id].parameters.size());
+      action.parameters.reserve(num_parameters);
+      action.variables.parameters.resize(num_parameters);
+      for (auto &parameter_variables : action.variables.parameters) {
+        if (reader.read(1) == 1) {
+          auto type = reader.read_index(problem_->types.size());
+          action.parameters.emplace_back(TypeIndex{type});
+          parameter_variables.num_values =
+              reader.read(problem_->constants_of_type[type].size());
+        } else {
+          action.parameters.emplace_back(
+              ConstantIndex{reader.read_index(problem_->constants.size())});
+          reader.read(0);
+        }
+        parameter_variables.variables.resize(reader.read(file.size()));
+        for (auto &variable : parameter_variables.variables) {
+          variable = reader.read(max_var);
+        }
+      }
+    }
+    if (!reader.at_end()) {
+      throw InvalidCacheFile{};
+    }
+    LOG_INFO(encoding_logger, "Loaded cached encoding from %s",
+             file_.c_str());
+    return std::make_unique<CachedEncoder>(problem_, std::move(file),
+                                           formula_begin, num_vars,
+                                           std::move(actions));
+  } catch (const InvalidCacheFile &) {
+    LOG_WARN(encoding_logger, "Ignoring invalid cache file %s", file_.c_str());
+    return nullptr;
+  }
+}
+
+void EncodingCache::store(const Encoder &encoder) const {
+  std::vector<uint64_t> words{file_magic, key_, encoder.get_num_vars()};
+  write_formula(encoder.get_init(), words);
+  write_formula(encoder.get_universal_clauses(), words);
+  write_formula(encoder.get_transition_clauses(), words);
+  write_formula(encoder.get_goal_clauses(), words);
+
+  const auto &problem = *encoder.get_problem();
+  auto action_variables = encoder.get_action_variables();
+  words.push_back(action_variables.size());
+  for (size_t i = 0; i < action_variables.size(); ++i) {
+    const auto &action = problem.actions[i];
+    words.push_back(action.id);
+    words.push_back(action_variables[i].sat_var);
+    words.push_back(action.parameters.size());
+    for (size_t parameter_pos = 0; parameter_pos < action.parameters.size();
+         ++parameter_pos) {
+      const auto &parameter = action.parameters[parameter_pos];
+      const auto &parameter_variables =
+          action_variables[i].parameters[parameter_pos];
+      words.push_back(parameter.is_free());
+      words.push_back(parameter.is_free() ? uint64_t{parameter.get_type()}
+                                          : uint64_t{parameter.get_constant()});
+      words.push_back(parameter_variables.num_values);
+      words.push_back(parameter_variables.variables.size());
+      words.insert(words.end(), parameter_variables.variables.begin(),
+                   parameter_variables.variables.end());
+    }
+  }
+
+  if (::mkdir(config.encoding_cache->c_str(), 0755) != 0 && errno != EEXIST) {
+    LOG_WARN(encoding_logger, "Could not create cache directory %s",
+             config.encoding_cache->c_str());
+    return;
+  }
+  // Readers never see partially written files, as renaming is atomic
+  auto tmp_file = file_ + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out{tmp_file, std::ios::binary};
+    out.write(reinterpret_cast<const char *>(words.data()),
+              static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));
+    if (!out) {
+      LOG_WARN(encoding_logger, "Could not write cache file %s",
+               tmp_file.c_str());
+      std::remove(tmp_file.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_file.c_str(), file_.c_str()) != 0) {
+    LOG_WARN(encoding_logger, "Could not write cache file %s", file_.c_str());
+    std::remove(tmp_file.c_str());
+    return;
+  }
+  LOG_INFO(encoding_logger, "Cached encoding in %s", file_.c_str());
+}
+
+CachedEncoder::CachedEncoder(
+    const std::shared_ptr<normalized::Problem> &problem, util::MappedFile file,
+    size_t formula_begin, uint_fast64_t num_vars,
+    std::vector<CachedAction> actions) noexcept
+    : Encoder{problem},
+      file_{std::move(file)},
+      formula_begin_{formula_begin},
+      cached_num_vars_{num_vars},
+      actions_{std::move(actions)} {}
+
+int CachedEncoder::to_sat_var(Literal l, unsigned int step) const noexcept {
+  uint_fast64_t variable = 0;
+  variable = l.variable.sat_var;
+  if (variable == DONTCARE) {
+    return static_cast<int>(SAT);
+  }
+  if (variable == SAT || variable == UNSAT) {
+    return (l.positive ? 1 : -1) * static_cast<int>(variable);
+  }
+  step += l.variable.this_step ? 0 : 1;
+  return (l.positive ? 1 : -1) * static_cast<int>(variable + step * num_vars_);
+}
+
+Plan CachedEncoder::extract_plan(const sat::Model &model,
+                                 unsigned int step) const noexcept {
+  Plan plan;
+  plan.problem = problem_;
+  for (unsigned int s = 0; s < step; ++s) {
+    for (const auto &action : actions_) {
+      if (model[action.variables.sat_var + s * num_vars_]) {
+        std::vector<ConstantIndex> constants;
+        for (size_t parameter_pos = 0; parameter_pos < action.parameters.size();
+             ++parameter_pos) {
+          auto &parameter = action.parameters[parameter_pos];
+          if (!parameter.is_free()) {
+            constants.push_back(parameter.get_constant());
+          } else {
+            auto j = get_parameter_value(
+                model, action.variables.parameters[parameter_pos],
+                s * num_vars_);
+            if (j < problem_->constants_of_type[parameter.get_type()].size()) {
+              constants.push_back(
+                  problem_->constants_of_type[parameter.get_type()][j]);
+            }
+          }
+          assert(constants.size() == parameter_pos + 1);
+        }
+        plan.sequence.emplace_back(action.id, std::move(constants));
+      }
+    }
+  }
+  return plan;
+}
+
+std::vector<Encoder::ActionVariables>
+CachedEncoder::get_action_variables() const {
+  std::vector<ActionVariables> action_variables;
+  action_variables.reserve(actions_.size());
+  for (const auto &action : actions_) {
+    action_variables.push_back(action.variables);
+  }
+  return action_variables;
+}
+
+void CachedEncoder::encode_impl() {
+  num_vars_ = cached_num_vars_;
+  auto pos = formula_begin_;
+  pos = read_formula(pos, init_);
+  pos = read_formula(pos, universal_clauses_);
+  pos = read_formula(pos, transition_clauses_);
+  read_formula(pos, goal_);
+  LOG_INFO(encoding_logger, "Variables per step: %lu", num_vars_);
+  LOG_INFO(encoding_logger, "Init clauses: %lu", init_.get_num_clauses());
+  LOG_INFO(encoding_logger, "Universal clauses: %lu",
+           universal_clauses_.get_num_clauses());
+  LOG_INFO(encoding_logger, "Transition clauses: %lu",
+           transition_clauses_.get_num_clauses());
+  LOG_INFO(encoding_logger, "Goal clauses: %lu", goal_.get_num_clauses());
+}
+
+Encoder::EncodingSize CachedEncoder::estimate_size_impl() const {
+  // The clause families are not cached
+  EncodingSize size;
+  size.num_vars = cached_num_vars_;
+  return size;
+}
+
+size_t CachedEncoder::read_formula(size_t pos, Formula &formula) const {
+  auto words = reinterpret_cast<const uint64_t *>(file_.data());
+  auto num_clauses = words[pos];
+  auto num_literals = words[pos + 1];
+  pos += 2;
+  formula.clause_offsets.assign(words + pos, words + pos + num_clauses + 1);
+  pos += num_clauses + 1;
+  formula.literals.clear();
+  formula.literals.reserve(num_literals);
+  for (size_t i = 0; i < num_literals; ++i) {
+    auto word = words[pos + i];
+    formula.literals.emplace_back(Variable{word >> 2, ((word >> 1) & 1) == 1},
+                                  (word & 1) == 1);
+  }
+  return pos + num_literals;
+}
@@ -0,0 +1,78 @@
+#ifndef ENCODING_CACHE_HPP
+#define ENCODING_CACHE_HPP
+
+#include "config.hpp"
+#include "encoder/encoder.hpp"
+#include "logging/logging.hpp"
+#include "model/normalized/model.hpp"
+#include "util/mapped_file.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+extern Config config;
+extern logging::Logger encoding_logger;
+
+// Stores encodings in the directory config.encoding_cache, one file per
+// normalized problem and grounding and encoding configuration. A file
+// consists of 64 bit words in native byte order:
+//   magic, key, number of variables per step
+//   for the init, universal, transition and goal formula:
+//     number of clauses, number of literals, clause offsets, literals
+//   number of actions, for each action:
+//     action id, action variable, number of parameters, for each parameter:
+//       free, constant or type, number of values, number of variables,
+//       variables
+// A literal is stored as (variable << 2) | (this step << 1) | positive. The
+// action ids refer to the normalized problem, so that plans can be extracted
+// without grounding it again.
+class EncodingCache {
+public:
+  explicit EncodingCache(const std::shared_ptr<normalized::Problem> &problem);
+
+  // Returns nullptr if no valid encoding is cached
+  std::unique_ptr<Encoder> load() const;
+  // The encoder must have encoded a grounding of the problem
+  void store(const Encoder &encoder) const;
+
+private:
+  uint64_t key_;
+  std::string file_;
+  std::shared_ptr<normalized::Problem> problem_;
+};
+
+// Encoder reading its formulas from a cache file
+class CachedEncoder final : public Encoder {
+public:
+  struct CachedAction {
+    normalized::ActionIndex id;
+    std::vector<normalized::Parameter> parameters;
+    ActionVariables variables;
+  };
+
+  // The data must be validated by EncodingCache::load
+  CachedEncoder(const std::shared_ptr<normalized::Problem> &problem,
+                util::MappedFile file, size_t formula_begin,
+                uint_fast64_t num_vars,
+                std::vector<CachedAction> actions) noexcept;
+
+  int to_sat_var(Literal l, unsigned int step) const noexcept override;
+  Plan extract_plan(const sat::Model &model, unsigned int num_steps) const
+      noexcept override;
+  std::vector<ActionVariables> get_action_variables() const override;
+
+private:
+  void encode_impl() override;
+  EncodingSize estimate_size_impl() const override;
+  size_t read_formula(size_t pos, Formula &formula) const;
+
+  util::MappedFile file_;
+  // Position of the first formula in words
+  size_t formula_begin_;
+  uint_fast64_t cached_num_vars_;
+  std::vector<CachedAction> actions_;
+};
+
+#endif /* end of include guard: ENCODING_CACHE_HPP */
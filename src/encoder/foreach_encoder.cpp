@@ -10,6 +10,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <unordered_set>
 #include <vector>
 
 using namespace normalized;
@@ -21,7 +23,7 @@ ForeachEncoder::ForeachEncoder(const std::shared_ptr<Problem> &problem,
   init_sat_vars();
 }
 
-void ForeachEncoder::encode() {
+void ForeachEncoder::encode_impl() {
   LOG_INFO(encoding_logger, "Encode problem...");
   encode_init();
   encode_actions();
@@ -36,12 +38,102 @@ void ForeachEncoder::encode() {
            std::accumulate(
                dnf_helpers_.begin(), dnf_helpers_.end(), 0ul,
                [](size_t sum, const auto &m) { return sum + m.size(); }));
-  LOG_INFO(encoding_logger, "Init clauses: %lu", init_.clauses.size());
+  LOG_INFO(encoding_logger, "Init clauses: %lu", init_.get_num_clauses());
   LOG_INFO(encoding_logger, "Universal clauses: %lu",
-           universal_clauses_.clauses.size());
+           universal_clauses_.get_num_clauses());
   LOG_INFO(encoding_logger, "Transition clauses: %lu",
-           transition_clauses_.clauses.size());
-  LOG_INFO(encoding_logger, "Goal clauses: %lu", goal_.clauses.size());
+           transition_clauses_.get_num_clauses());
+  LOG_INFO(encoding_logger, "Goal clauses: %lu", goal_.get_num_clauses());
+}
+
+Encoder::EncodingSize ForeachEncoder::estimate_size_impl() const {
+  EncodingSize size;
+  size.num_vars = num_vars_ - 3;
+  for (size_t i = 0; i < problem_->actions.size(); ++i) {
+    const auto &action = problem_->actions[i];
+    for (size_t parameter_pos = 0; parameter_pos < action.parameters.size();
+         ++parameter_pos) {
+      if (action.parameters[parameter_pos].is_free()) {
+        estimate_parameter(parameters_[i][parameter_pos], size);
+      }
+    }
+  }
+  std::vector<size_t> num_effects(problem_->actions.size(), 0);
+  auto is_nontrivial = [](const auto &assignment) {
+    return assignment.size() > (config.parameter_implies_action ? 1 : 0);
+  };
+  auto get_num_literals = [this](ActionIndex action_index,
+                                 const Support::Assignment &assignment) {
+    size_t num_literals = 0;
+    for (const auto &[parameter_index, constant] : assignment) {
+      auto index =
+          get_constant_index(constant, problem_->actions[action_index]
+                                           .parameters[parameter_index]
+                                           .get_type());
+      num_literals += get_num_parameter_literals(
+          parameters_[action_index][parameter_index], index);
+    }
+    return num_literals;
+  };
+  std::vector<std::unordered_set<Support::Assignment>> helpers(
+      problem_->actions.size());
+  for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
+    for (bool positive : {true, false}) {
+      for (bool is_effect : {true, false}) {
+        size.implication_clauses +=
+            support_.get_support(Support::PredicateId{i}, positive, is_effect)
+                .size();
+      }
+      // Interference clauses for all pairs of different actions
+      const auto &precondition_support =
+          support_.get_support(Support::PredicateId{i}, positive, false);
+      const auto &effect_support =
+          support_.get_support(Support::PredicateId{i}, !positive, true);
+      for (const auto &entry : effect_support) {
+        ++num_effects[entry.action_index];
+      }
+      uint_fast64_t num_pairs =
+          precondition_support.size() * effect_support.size();
+      for (const auto &entry : precondition_support) {
+        num_pairs -= num_effects[entry.action_index];
+      }
+      for (const auto &entry : effect_support) {
+        num_effects[entry.action_index] = 0;
+      }
+      size.interference_clauses += num_pairs;
+      const auto &support =
+          support_.get_support(Support::PredicateId{i}, positive, true);
+      auto use_helper =
+          config.dnf_threshold > 0 &&
+          static_cast<size_t>(std::count_if(
+              support.begin(), support.end(), [&](const auto &s) {
+                return is_nontrivial(s.assignment);
+              })) >= config.dnf_threshold;
+      // The frame axiom is a dnf with two unit terms for the atom itself and
+      // one term per support
+      uint_fast64_t num_clauses = 1;
+      for (const auto &[action_index, assignment] : support) {
+        if (use_helper && is_nontrivial(assignment)) {
+          if (helpers[action_index].insert(assignment).second) {
+            ++size.num_vars;
+            size.frame_axiom_clauses +=
+                (config.parameter_implies_action ? 0 : 1) +
+                get_num_literals(action_index, assignment);
+          }
+          continue;
+        }
+        auto term_size = get_num_literals(action_index, assignment);
+        if (!config.parameter_implies_action || assignment.empty()) {
+          ++term_size;
+        }
+        num_clauses = multiply_dnf_size(num_clauses, term_size);
+      }
+      size.frame_axiom_clauses +=
+          std::min(num_clauses, std::numeric_limits<uint_fast64_t>::max() -
+                                    size.frame_axiom_clauses);
+    }
+  }
+  return size;
 }
 
 int ForeachEncoder::to_sat_var(Literal l, unsigned int step) const noexcept {
@@ -72,14 +164,11 @@ Plan ForeachEncoder::extract_plan(const sat::Model &model,
           if (!parameter.is_free()) {
             constants.push_back(parameter.get_constant());
           } else {
-            for (size_t j = 0;
-                 j < problem_->constants_of_type[parameter.get_type()].size();
-                 ++j) {
-              if (model[parameters_[i][parameter_pos][j] + s * num_vars_]) {
-                constants.push_back(
-                    problem_->constants_of_type[parameter.get_type()][j]);
-                break;
-              }
+            auto j = get_parameter_value(
+                model, parameters_[i][parameter_pos], s * num_vars_);
+            if (j < problem_->constants_of_type[parameter.get_type()].size()) {
+              constants.push_back(
+                  problem_->constants_of_type[parameter.get_type()][j]);
             }
           }
           assert(constants.size() == parameter_pos + 1);
@@ -91,6 +180,16 @@ Plan ForeachEncoder::extract_plan(const sat::Model &model,
   return plan;
 }
 
+std::vector<Encoder::ActionVariables>
+ForeachEncoder::get_action_variables() const {
+  std::vector<ActionVariables> action_variables;
+  action_variables.reserve(actions_.size());
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    action_variables.push_back({actions_[i], parameters_[i]});
+  }
+  return action_variables;
+}
+
 void ForeachEncoder::init_sat_vars() {
   actions_.reserve(problem_->actions.size());
   parameters_.resize(problem_->actions.size());
@@ -107,12 +206,8 @@ void ForeachEncoder::init_sat_vars() {
       if (!parameter.is_free()) {
         continue;
       }
-      parameters_[i][parameter_pos].reserve(
+      parameters_[i][parameter_pos] = init_parameter(
           problem_->constants_of_type[parameter.get_type()].size());
-      for (size_t j = 0;
-           j < problem_->constants_of_type[parameter.get_type()].size(); ++j) {
-        parameters_[i][parameter_pos].push_back(num_vars_++);
-      }
     }
   }
 
@@ -157,180 +252,193 @@ void ForeachEncoder::encode_actions() {
       if (!parameter.is_free()) {
         continue;
       }
-      size_t number_arguments =
-          problem_->constants_of_type[parameter.get_type()].size();
-      std::vector<Variable> all_arguments;
-      all_arguments.reserve(number_arguments);
-      universal_clauses_ << Literal{action_var, false};
-      for (size_t constant_index = 0; constant_index < number_arguments;
-           ++constant_index) {
-        auto argument = Variable{parameters_[i][parameter_pos][constant_index]};
-        universal_clauses_ << Literal{argument, true};
-        all_arguments.push_back(argument);
-      }
-      universal_clauses_ << sat::EndClause;
-      ++clause_count;
-      clause_count += universal_clauses_.at_most_one(all_arguments);
-      if (config.parameter_implies_action) {
-        for (auto argument : all_arguments) {
-          universal_clauses_ << Literal{argument, false};
-          universal_clauses_ << Literal{action_var, true};
-          universal_clauses_ << sat::EndClause;
-        }
-        clause_count += all_arguments.size();
-      }
+      clause_count +=
+          encode_parameter(action_var, parameters_[i][parameter_pos]);
     }
   }
   LOG_INFO(encoding_logger, "Action clauses: %lu", clause_count);
 }
 
 void ForeachEncoder::parameter_implies_predicate() {
-  uint_fast64_t clause_count = 0;
-  for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
-    if (check_timeout()) {
-      throw TimeoutException{};
-    }
-    for (bool positive : {true, false}) {
-      for (bool is_effect : {true, false}) {
-        auto &formula = is_effect ? transition_clauses_ : universal_clauses_;
-        for (const auto &[action_index, assignment] : support_.get_support(
-                 Support::PredicateId{i}, positive, is_effect)) {
-          if (!config.parameter_implies_action || assignment.empty()) {
-            formula << Literal{Variable{actions_[action_index]}, false};
-          }
-          for (const auto &[parameter_index, constant] : assignment) {
-            auto index =
-                get_constant_index(constant, problem_->actions[action_index]
-                                                 .parameters[parameter_index]
-                                                 .get_type());
-            formula << Literal{
-                Variable{parameters_[action_index][parameter_index][index]},
-                false};
+  auto clause_count = generate_clauses(
+      support_.get_num_ground_atoms(),
+      [this](size_t i, Formula &universal, Formula &transition, Formula &) {
+        if (check_timeout()) {
+          throw TimeoutException{};
+        }
+        uint_fast64_t clause_count = 0;
+        for (bool positive : {true, false}) {
+          for (bool is_effect : {true, false}) {
+            auto &formula = is_effect ? transition : universal;
+            for (const auto &[action_index, assignment] : support_.get_support(
+                     Support::PredicateId{i}, positive, is_effect)) {
+              if (!config.parameter_implies_action || assignment.empty()) {
+                formula << Literal{Variable{actions_[action_index]}, false};
+              }
+              for (const auto &[parameter_index, constant] : assignment) {
+                auto index = get_constant_index(
+                    constant, problem_->actions[action_index]
+                                  .parameters[parameter_index]
+                                  .get_type());
+                add_parameter_value(formula,
+                                    parameters_[action_index][parameter_index],
+                                    index, false);
+              }
+              formula << Literal{Variable{predicates_[i], !is_effect},
+                                 positive}
+                      << sat::EndClause;
+              ++clause_count;
+            }
           }
-          formula << Literal{Variable{predicates_[i], !is_effect}, positive}
-                  << sat::EndClause;
-          ++clause_count;
         }
-      }
-    }
-  }
+        return clause_count;
+      });
   LOG_INFO(encoding_logger, "Implication clauses: %lu", clause_count);
 }
 
 void ForeachEncoder::interference() {
-  uint_fast64_t clause_count = 0;
-  for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
-    if (check_timeout()) {
-      throw TimeoutException{};
-    }
-    for (bool positive : {true, false}) {
-      const auto &precondition_support =
-          support_.get_support(Support::PredicateId{i}, positive, false);
-      const auto &effect_support =
-          support_.get_support(Support::PredicateId{i}, !positive, true);
-      for (const auto &[p_action_index, p_assignment] : precondition_support) {
-        for (const auto &[e_action_index, e_assignment] : effect_support) {
-          if (p_action_index == e_action_index) {
-            continue;
-          }
-          for (bool is_effect : {true, false}) {
-            const auto &assignment = is_effect ? e_assignment : p_assignment;
-            auto action_index = is_effect ? e_action_index : p_action_index;
-            if (!config.parameter_implies_action || assignment.empty()) {
-              universal_clauses_
-                  << Literal{Variable{actions_[action_index]}, false};
-            }
-            for (const auto &[parameter_index, constant] : assignment) {
-              auto index =
-                  get_constant_index(constant, problem_->actions[action_index]
-                                                   .parameters[parameter_index]
-                                                   .get_type());
-              universal_clauses_ << Literal{
-                  Variable{parameters_[action_index][parameter_index][index]},
-                  false};
+  auto clause_count = generate_clauses(
+      support_.get_num_ground_atoms(),
+      [this](size_t i, Formula &universal, Formula &, Formula &) {
+        if (check_timeout()) {
+          throw TimeoutException{};
+        }
+        uint_fast64_t clause_count = 0;
+        for (bool positive : {true, false}) {
+          const auto &precondition_support =
+              support_.get_support(Support::PredicateId{i}, positive, false);
+          const auto &effect_support =
+              support_.get_support(Support::PredicateId{i}, !positive, true);
+          for (const auto &[p_action_index, p_assignment] :
+               precondition_support) {
+            for (const auto &[e_action_index, e_assignment] : effect_support) {
+              if (p_action_index == e_action_index) {
+                continue;
+              }
+              for (bool is_effect : {true, false}) {
+                const auto &assignment =
+                    is_effect ? e_assignment : p_assignment;
+                auto action_index = is_effect ? e_action_index : p_action_index;
+                if (!config.parameter_implies_action || assignment.empty()) {
+                  universal << Literal{Variable{actions_[action_index]}, false};
+                }
+                for (const auto &[parameter_index, constant] : assignment) {
+                  auto index = get_constant_index(
+                      constant, problem_->actions[action_index]
+                                    .parameters[parameter_index]
+                                    .get_type());
+                  add_parameter_value(
+                      universal, parameters_[action_index][parameter_index],
+                      index, false);
+                }
+              }
+              universal << sat::EndClause;
+              ++clause_count;
             }
           }
-          universal_clauses_ << sat::EndClause;
-          ++clause_count;
         }
-      }
-    }
-  }
+        return clause_count;
+      });
   LOG_INFO(encoding_logger, "Interference clauses: %lu", clause_count);
 }
 
 void ForeachEncoder::frame_axioms() {
   uint_fast64_t clause_count = 0;
+  // Assignments with multiple arguments lead to combinatorial explosion
+  auto is_nontrivial = [](const auto &assignment) {
+    return assignment.size() > (config.parameter_implies_action ? 1 : 0);
+  };
+  // Helper variables are allocated in order of the atoms before generating
+  // the frame axioms, so that the variables do not depend on the number of
+  // encoding threads
+  std::vector<bool> use_helper(2 * support_.get_num_ground_atoms(), false);
   for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
     if (check_timeout()) {
       throw TimeoutException{};
     }
     for (bool positive : {true, false}) {
-      bool use_helper = false;
-      if (config.dnf_threshold > 0) {
-        size_t num_nontrivial_clauses = 0;
-        for (const auto &[action_index, assignment] :
-             support_.get_support(Support::PredicateId{i}, positive, true)) {
-          // Assignments with multiple arguments lead to combinatorial explosion
-          if (assignment.size() > (config.parameter_implies_action ? 1 : 0)) {
-            ++num_nontrivial_clauses;
-          }
-        }
-        use_helper = num_nontrivial_clauses >= config.dnf_threshold;
+      const auto &support =
+          support_.get_support(Support::PredicateId{i}, positive, true);
+      if (config.dnf_threshold == 0 ||
+          static_cast<size_t>(std::count_if(
+              support.begin(), support.end(), [&](const auto &s) {
+                return is_nontrivial(s.assignment);
+              })) < config.dnf_threshold) {
+        continue;
       }
-      Formula dnf;
-      dnf << Literal{Variable{predicates_[i], true}, positive}
-          << sat::EndClause;
-      dnf << Literal{Variable{predicates_[i], false}, !positive}
-          << sat::EndClause;
-      for (const auto &[action_index, assignment] :
-           support_.get_support(Support::PredicateId{i}, positive, true)) {
-        if (use_helper &&
-            assignment.size() > (config.parameter_implies_action ? 1 : 0)) {
-          auto [it, success] =
-              dnf_helpers_[action_index].try_emplace(assignment, num_vars_);
-          if (success) {
-            if (!config.parameter_implies_action) {
-              universal_clauses_ << Literal{Variable{it->second}, false};
-              universal_clauses_
-                  << Literal{Variable{actions_[action_index]}, true};
-              universal_clauses_ << sat::EndClause;
-              ++clause_count;
-            }
-            for (const auto &[parameter_index, constant] : assignment) {
-              auto index =
-                  get_constant_index(constant, problem_->actions[action_index]
-                                                   .parameters[parameter_index]
-                                                   .get_type());
-              universal_clauses_ << Literal{Variable{it->second}, false};
-              universal_clauses_ << Literal{
-                  Variable{parameters_[action_index][parameter_index][index]},
-                  true};
-              universal_clauses_ << sat::EndClause;
-            }
-            ++num_vars_;
-            clause_count += assignment.size();
-          }
-          dnf << Literal{Variable{it->second}, true};
-        } else {
-          if (!config.parameter_implies_action || assignment.empty()) {
-            dnf << Literal{Variable{actions_[action_index]}, true};
-          }
-          for (const auto &[parameter_index, constant] : assignment) {
-            auto index =
-                get_constant_index(constant, problem_->actions[action_index]
-                                                 .parameters[parameter_index]
-                                                 .get_type());
-            dnf << Literal{
-                Variable{parameters_[action_index][parameter_index][index]},
-                true};
-          }
+      use_helper[2 * i + (positive ? 0 : 1)] = true;
+      for (const auto &[action_index, assignment] : support) {
+        if (!is_nontrivial(assignment)) {
+          continue;
+        }
+        auto [it, success] =
+            dnf_helpers_[action_index].try_emplace(assignment, num_vars_);
+        if (!success) {
+          continue;
+        }
+        auto helper = Variable{it->second};
+        if (!config.parameter_implies_action) {
+          universal_clauses_ << Literal{helper, false};
+          universal_clauses_ << Literal{Variable{actions_[action_index]}, true};
+          universal_clauses_ << sat::EndClause;
+          ++clause_count;
+        }
+        for (const auto &[parameter_index, constant] : assignment) {
+          auto index =
+              get_constant_index(constant, problem_->actions[action_index]
+                                               .parameters[parameter_index]
+                                               .get_type());
+          for_each_parameter_literal(
+              parameters_[action_index][parameter_index], index,
+              [&](Literal l) {
+                universal_clauses_ << Literal{helper, false} << l
+                                   << sat::EndClause;
+                ++clause_count;
+              });
         }
-        dnf << sat::EndClause;
+        ++num_vars_;
       }
-      clause_count += transition_clauses_.add_dnf(dnf);
     }
   }
+  clause_count += generate_clauses(
+      support_.get_num_ground_atoms(),
+      [&](size_t i, Formula &, Formula &transition, Formula &dnf) {
+        if (check_timeout()) {
+          throw TimeoutException{};
+        }
+        uint_fast64_t clause_count = 0;
+        for (bool positive : {true, false}) {
+          dnf.clear();
+          dnf << Literal{Variable{predicates_[i], true}, positive}
+              << sat::EndClause;
+          dnf << Literal{Variable{predicates_[i], false}, !positive}
+              << sat::EndClause;
+          for (const auto &[action_index, assignment] :
+               support_.get_support(Support::PredicateId{i}, positive, true)) {
+            if (use_helper[2 * i + (positive ? 0 : 1)] &&
+                is_nontrivial(assignment)) {
+              dnf << Literal{
+                  Variable{dnf_helpers_[action_index].at(assignment)}, true};
+            } else {
+              if (!config.parameter_implies_action || assignment.empty()) {
+                dnf << Literal{Variable{actions_[action_index]}, true};
+              }
+              for (const auto &[parameter_index, constant] : assignment) {
+                auto index = get_constant_index(
+                    constant, problem_->actions[action_index]
+                                  .parameters[parameter_index]
+                                  .get_type());
+                add_parameter_value(dnf,
+                                    parameters_[action_index][parameter_index],
+                                    index, true);
+              }
+            }
+            dnf << sat::EndClause;
+          }
+          clause_count += transition.add_dnf(dnf);
+        }
+        return clause_count;
+      });
   LOG_INFO(encoding_logger, "Frame axiom clauses: %lu", clause_count);
 }
 
@@ -18,27 +18,31 @@ public:
   explicit LiftedForeachEncoder(
       const std::shared_ptr<normalized::Problem> &problem, util::Seconds timeout);
 
-  void encode() override;
-
   int to_sat_var(Literal l, unsigned int step) const noexcept override;
   Plan extract_plan(const sat::Model &model, unsigned int num_steps) const
       noexcept override;
+  std::vector<ActionVariables> get_action_variables() const override;
 
 private:
+  void encode_impl() override;
+  EncodingSize estimate_size_impl() const override;
   size_t get_constant_index(normalized::ConstantIndex constant,
                             normalized::TypeIndex type) const noexcept;
   void encode_init();
   void encode_actions();
   void parameter_implies_predicate();
   void interference();
+  bool has_disabling_effect(const normalized::Action &first_action,
+                            const normalized::Action &second_action) const
+      noexcept;
   void frame_axioms();
   void assume_goal();
   void init_sat_vars();
 
   std::vector<uint_fast64_t> predicates_;
   std::vector<uint_fast64_t> actions_;
-  std::vector<std::vector<std::vector<uint_fast64_t>>> parameters_;
-  std::vector<std::unordered_map<normalized::ParameterAssignment, uint_fast64_t>>
+  std::vector<std::vector<ParameterVariables>> parameters_;
+  std::vector<std::unordered_map<Support::Assignment, uint_fast64_t>>
       dnf_helpers_;
 
   Support support_;
@@ -12,6 +12,8 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <unordered_set>
 #include <vector>
 
 using namespace normalized;
@@ -23,7 +25,7 @@ SequentialEncoder::SequentialEncoder(const std::shared_ptr<Problem> &problem,
   init_sat_vars();
 }
 
-void SequentialEncoder::encode() {
+void SequentialEncoder::encode_impl() {
   LOG_INFO(encoding_logger, "Encode problem...");
   encode_init();
   encode_actions();
@@ -37,12 +39,66 @@ void SequentialEncoder::encode() {
            std::accumulate(
                dnf_helpers_.begin(), dnf_helpers_.end(), 0ul,
                [](size_t sum, const auto &m) { return sum + m.size(); }));
-  LOG_INFO(encoding_logger, "Init clauses: %lu", init_.clauses.size());
+  LOG_INFO(encoding_logger, "Init clauses: %lu", init_.get_num_clauses());
   LOG_INFO(encoding_logger, "Universal clauses: %lu",
-           universal_clauses_.clauses.size());
+           universal_clauses_.get_num_clauses());
   LOG_INFO(encoding_logger, "Transition clauses: %lu",
-           transition_clauses_.clauses.size());
-  LOG_INFO(encoding_logger, "Goal clauses: %lu", goal_.clauses.size());
+           transition_clauses_.get_num_clauses());
+  LOG_INFO(encoding_logger, "Goal clauses: %lu", goal_.get_num_clauses());
+}
+
+Encoder::EncodingSize SequentialEncoder::estimate_size_impl() const {
+  EncodingSize size;
+  size.num_vars = num_vars_ - 3;
+  auto parameter_size = sat::get_at_most_one_size(problem_->constants.size(),
+                                                  config.at_most_one_encoding);
+  size.action_clauses += parameters_.size() * parameter_size.num_clauses;
+  size.num_vars += parameters_.size() * parameter_size.num_vars;
+  for (const auto &action : problem_->actions) {
+    size.action_clauses += static_cast<size_t>(
+        std::count_if(action.parameters.begin(), action.parameters.end(),
+                      [](const Parameter &p) { return p.is_free(); }));
+  }
+  auto action_size = sat::get_at_most_one_size(problem_->actions.size(),
+                                               config.at_most_one_encoding);
+  size.action_clauses += action_size.num_clauses;
+  size.num_vars += action_size.num_vars;
+  std::vector<std::unordered_set<Support::Assignment>> helpers(
+      problem_->actions.size());
+  for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
+    for (bool positive : {true, false}) {
+      for (bool is_effect : {true, false}) {
+        size.implication_clauses +=
+            support_.get_support(Support::PredicateId{i}, positive, is_effect)
+                .size();
+      }
+      const auto &support =
+          support_.get_support(Support::PredicateId{i}, positive, true);
+      auto use_helper =
+          config.dnf_threshold > 0 &&
+          static_cast<size_t>(std::count_if(
+              support.begin(), support.end(),
+              [](const auto &s) { return !s.assignment.empty(); })) >=
+              config.dnf_threshold;
+      // The frame axiom is a dnf with two unit terms for the atom itself and
+      // one term per support
+      uint_fast64_t num_clauses = 1;
+      for (const auto &[action_index, assignment] : support) {
+        if (use_helper && !assignment.empty()) {
+          if (helpers[action_index].insert(assignment).second) {
+            ++size.num_vars;
+            size.frame_axiom_clauses += 1 + assignment.size();
+          }
+          continue;
+        }
+        num_clauses = multiply_dnf_size(num_clauses, 1 + assignment.size());
+      }
+      size.frame_axiom_clauses +=
+          std::min(num_clauses, std::numeric_limits<uint_fast64_t>::max() -
+                                    size.frame_axiom_clauses);
+    }
+  }
+  return size;
 }
 
 int SequentialEncoder::to_sat_var(Literal l, unsigned int step) const noexcept {
@@ -90,6 +146,36 @@ Plan SequentialEncoder::extract_plan(const sat::Model &model,
   return plan;
 }
 
+std::vector<Encoder::ActionVariables>
+SequentialEncoder::get_action_variables() const {
+  std::vector<ActionVariables> action_variables;
+  action_variables.reserve(actions_.size());
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    const auto &action = problem_->actions[i];
+    ActionVariables variables{actions_[i], {}};
+    variables.parameters.resize(action.parameters.size());
+    for (size_t parameter_pos = 0; parameter_pos < action.parameters.size();
+         ++parameter_pos) {
+      const auto &parameter = action.parameters[parameter_pos];
+      if (!parameter.is_free()) {
+        continue;
+      }
+      // The parameter variables are shared by all actions and range over all
+      // constants, but only those of the parameter type can be true
+      const auto &constants = problem_->constants_of_type[parameter.get_type()];
+      auto &parameter_variables = variables.parameters[parameter_pos];
+      parameter_variables.num_values = constants.size();
+      parameter_variables.variables.reserve(constants.size());
+      for (auto constant : constants) {
+        parameter_variables.variables.push_back(
+            parameters_[parameter_pos][constant]);
+      }
+    }
+    action_variables.push_back(std::move(variables));
+  }
+  return action_variables;
+}
+
 void SequentialEncoder::init_sat_vars() {
   actions_.reserve(problem_->actions.size());
   auto last_parameter = [](const auto &action) {
@@ -143,7 +229,9 @@ void SequentialEncoder::encode_actions() {
     for (size_t j = 0; j < problem_->constants.size(); ++j) {
       all_arguments.push_back(Variable{parameters_[i][j]});
     }
-    clause_count += universal_clauses_.at_most_one(all_arguments);
+    clause_count += universal_clauses_.at_most_one(
+        all_arguments, config.at_most_one_encoding,
+        [this]() { return Variable{num_vars_++}; });
   }
   std::vector<Variable> all_actions;
   all_actions.reserve(problem_->actions.size());
@@ -171,7 +259,9 @@ void SequentialEncoder::encode_actions() {
     }
     all_actions.push_back(action_var);
   }
-  clause_count += universal_clauses_.at_most_one(all_actions);
+  clause_count += universal_clauses_.at_most_one(
+      all_actions, config.at_most_one_encoding,
+      [this]() { return Variable{num_vars_++}; });
   LOG_INFO(encoding_logger, "Action clauses: %lu", clause_count);
 }
 
@@ -203,6 +293,7 @@ void SequentialEncoder::parameter_implies_predicate() {
 
 void SequentialEncoder::frame_axioms() {
   uint_fast64_t clause_count = 0;
+  Formula dnf;
   for (size_t i = 0; i < support_.get_num_ground_atoms(); ++i) {
     if (check_timeout()) {
       throw TimeoutException{};
@@ -220,7 +311,7 @@ void SequentialEncoder::frame_axioms() {
         }
         use_helper = num_nontrivial_clauses >= config.dnf_threshold;
       }
-      Formula dnf;
+      dnf.clear();
       dnf << Literal{Variable{predicates_[i], true}, positive}
           << sat::EndClause;
       dnf << Literal{Variable{predicates_[i], false}, !positive}
@@ -18,13 +18,14 @@ public:
   explicit SequentialEncoder(
       const std::shared_ptr<normalized::Problem> &problem, util::Seconds timeout);
 
-  void encode() override;
-
   int to_sat_var(Literal l, unsigned int step) const noexcept override;
   Plan extract_plan(const sat::Model &model, unsigned int num_steps) const
       noexcept override;
+  std::vector<ActionVariables> get_action_variables() const override;
 
 private:
+  void encode_impl() override;
+  EncodingSize estimate_size_impl() const override;
   void encode_init();
   void encode_actions();
   void parameter_implies_predicate();
@@ -35,7 +36,7 @@ private:
   std::vector<uint_fast64_t> predicates_;
   std::vector<uint_fast64_t> actions_;
   std::vector<std::vector<uint_fast64_t>> parameters_;
-  std::vector<std::unordered_map<normalized::ParameterAssignment, uint_fast64_t>>
+  std::vector<std::unordered_map<Support::Assignment, uint_fast64_t>>
       dnf_helpers_;
 
   Support support_;
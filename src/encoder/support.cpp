@@ -15,30 +15,51 @@ using namespace normalized;
 
 Support::Support(const Problem &problem, util::Seconds timeout = util::inf_time)
     : timeout_{timeout}, problem_{problem}{
-  num_ground_atoms_ =
-      std::accumulate(problem.predicates.begin(), problem.predicates.end(), 0ul,
-                      [&problem](size_t sum, const auto &p) {
-                        return sum + get_num_instantiated(p, problem);
-                      });
-  ground_atoms_.reserve(num_ground_atoms_);
-  init_.reserve(problem_.init.size());
+  set_ground_atom_ids();
+  init_.resize(num_ground_atoms_, false);
   for (const auto &predicate : problem_.init) {
-    auto id = get_id(predicate);
-    init_.insert(id);
+    init_[get_id(predicate)] = true;
   }
   set_predicate_support();
 }
 
-void Support::set_predicate_support() {
-  condition_supports_.resize(num_ground_atoms_);
+void Support::set_ground_atom_ids() {
+  predicate_offsets_.reserve(problem_.predicates.size());
+  strides_.resize(problem_.predicates.size());
+  constant_indices_.resize(problem_.types.size());
+  for (size_t i = 0; i < problem_.predicates.size(); ++i) {
+    const auto &types = problem_.predicates[i].parameter_types;
+    predicate_offsets_.push_back(num_ground_atoms_);
+    strides_[i].resize(types.size());
+    size_t stride = 1;
+    for (size_t j = types.size(); j-- > 0;) {
+      strides_[i][j] = stride;
+      stride *= problem_.constants_of_type[types[j]].size();
+    }
+    num_ground_atoms_ += stride;
+    for (auto type : types) {
+      auto &indices = constant_indices_[type];
+      if (!indices.empty()) {
+        continue;
+      }
+      indices.resize(problem_.constants.size(), problem_.constants.size());
+      const auto &constants = problem_.constants_of_type[type];
+      for (size_t j = 0; j < constants.size(); ++j) {
+        indices[constants[j]] = j;
+      }
+    }
+  }
+}
+
+template <typename F> void Support::for_each_support(F &&f) {
+  const ParameterAssignment empty_assignment;
   for (size_t i = 0; i < problem_.actions.size(); ++i) {
     const auto &action = problem_.actions[i];
     for (auto is_effect : {true, false}) {
       for (const auto &[predicate, positive] :
            (is_effect ? action.ground_effects : action.ground_preconditions)) {
-        auto id = get_id(predicate);
-        select_support(id, positive, is_effect)
-            .emplace_back(ActionIndex{i}, ParameterAssignment{});
+        f(get_id(predicate), positive, is_effect, ActionIndex{i},
+          empty_assignment);
       }
       for (const auto &condition :
            is_effect ? action.effects : action.preconditions) {
@@ -53,11 +74,56 @@ void Support::set_predicate_support() {
 #endif
         for (GroundAtomIterator it{condition.atom, action, problem_};
              it != GroundAtomIterator{}; ++it) {
-          auto id = get_id(*it);
-          select_support(id, condition.positive, is_effect)
-              .emplace_back(ActionIndex{i}, std::move(it.get_assignment()));
+          f(get_id(*it), condition.positive, is_effect, ActionIndex{i},
+            it.get_assignment());
         }
       }
     }
   }
 }
+
+void Support::set_predicate_support() {
+  // The first pass counts the supports and assignment entries per atom, the
+  // second one fills them in at the positions given by the prefix sums
+  std::array<std::vector<size_t>, 4> entry_positions;
+  std::array<std::vector<size_t>, 4> assignment_positions;
+  for (size_t k = 0; k < supports_.size(); ++k) {
+    supports_[k].offsets.assign(num_ground_atoms_ + 1, 0);
+    assignment_positions[k].assign(num_ground_atoms_ + 1, 0);
+  }
+  for_each_support([this, &assignment_positions](
+                       PredicateId id, bool positive, bool is_effect,
+                       ActionIndex, const ParameterAssignment &assignment) {
+    auto k = get_table_index(positive, is_effect);
+    ++supports_[k].offsets[id + 1];
+    assignment_positions[k][id + 1] += assignment.size();
+  });
+  for (size_t k = 0; k < supports_.size(); ++k) {
+    auto &table = supports_[k];
+    std::partial_sum(table.offsets.begin(), table.offsets.end(),
+                     table.offsets.begin());
+    std::partial_sum(assignment_positions[k].begin(),
+                     assignment_positions[k].end(),
+                     assignment_positions[k].begin());
+    table.actions.resize(table.offsets.back());
+    table.assignment_offsets.resize(table.offsets.back() + 1);
+    table.assignment_offsets.back() = assignment_positions[k].back();
+    table.assignments.resize(assignment_positions[k].back());
+    entry_positions[k] = table.offsets;
+  }
+  for_each_support([this, &entry_positions, &assignment_positions](
+                       PredicateId id, bool positive, bool is_effect,
+                       ActionIndex action_index,
+                       const ParameterAssignment &assignment) {
+    auto k = get_table_index(positive, is_effect);
+    auto &table = supports_[k];
+    auto entry = entry_positions[k][id]++;
+    auto &position = assignment_positions[k][id];
+    table.actions[entry] = action_index;
+    table.assignment_offsets[entry] = position;
+    std::copy(assignment.begin(), assignment.end(),
+              table.assignments.begin() +
+                  static_cast<std::ptrdiff_t>(position));
+    position += assignment.size();
+  });
+}
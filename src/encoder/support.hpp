@@ -10,8 +10,10 @@
 #include "util/index.hpp"
 #include "util/timer.hpp"
 
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <numeric>
-#include <unordered_set>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -24,19 +26,110 @@ class Support {
 public:
   struct predicate_id_t {};
   using PredicateId = util::Index<predicate_id_t>;
-  struct ConditionSupport {
-    std::vector<
-        std::pair<normalized::ActionIndex, normalized::ParameterAssignment>>
-        pos_precondition;
-    std::vector<
-        std::pair<normalized::ActionIndex, normalized::ParameterAssignment>>
-        neg_precondition;
-    std::vector<
-        std::pair<normalized::ActionIndex, normalized::ParameterAssignment>>
-        pos_effect;
-    std::vector<
-        std::pair<normalized::ActionIndex, normalized::ParameterAssignment>>
-        neg_effect;
+  using AssignmentEntry =
+      std::pair<normalized::ParameterIndex, normalized::ConstantIndex>;
+
+  // Non-owning view of a parameter assignment in the packed storage of the
+  // support. Equal assignments compare equal regardless of their location.
+  class Assignment {
+  public:
+    Assignment(const AssignmentEntry *first,
+               const AssignmentEntry *last) noexcept
+        : first_{first}, last_{last} {}
+
+    inline const AssignmentEntry *begin() const noexcept { return first_; }
+    inline const AssignmentEntry *end() const noexcept { return last_; }
+    inline size_t size() const noexcept {
+      return static_cast<size_t>(last_ - first_);
+    }
+    inline bool empty() const noexcept { return first_ == last_; }
+
+    bool operator==(const Assignment &other) const noexcept {
+      return std::equal(first_, last_, other.first_, other.last_);
+    }
+
+  private:
+    const AssignmentEntry *first_;
+    const AssignmentEntry *last_;
+  };
+
+  struct Entry {
+    normalized::ActionIndex action_index;
+    Assignment assignment;
+  };
+
+  // The supports of one kind (polarity and effect or precondition) of all
+  // ground atoms in compressed sparse row format: the supports of atom i are
+  // the entries offsets[i] up to offsets[i + 1], and the assignment of entry
+  // j are assignments[assignment_offsets[j]] up to
+  // assignments[assignment_offsets[j + 1]].
+  struct SupportTable {
+    std::vector<size_t> offsets;
+    std::vector<normalized::ActionIndex> actions;
+    std::vector<size_t> assignment_offsets;
+    std::vector<AssignmentEntry> assignments;
+  };
+
+  // View of the supports of one ground atom
+  class SupportSpan {
+  public:
+    class Iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Entry;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Entry *;
+      using reference = Entry;
+
+      Iterator(const SupportTable &table, size_t index) noexcept
+          : table_{&table}, index_{index} {}
+
+      inline Entry operator*() const noexcept {
+        return Entry{table_->actions[index_],
+                     Assignment{table_->assignments.data() +
+                                    table_->assignment_offsets[index_],
+                                table_->assignments.data() +
+                                    table_->assignment_offsets[index_ + 1]}};
+      }
+
+      Iterator &operator++() noexcept {
+        ++index_;
+        return *this;
+      }
+
+      Iterator operator++(int) noexcept {
+        auto old = *this;
+        ++(*this);
+        return old;
+      }
+
+      bool operator==(const Iterator &other) const noexcept {
+        return index_ == other.index_;
+      }
+
+      bool operator!=(const Iterator &other) const noexcept {
+        return !(*this == other);
+      }
+
+    private:
+      const SupportTable *table_;
+      size_t index_;
+    };
+
+    SupportSpan(const SupportTable &table, size_t first, size_t last) noexcept
+        : table_{&table}, first_{first}, last_{last} {}
+
+    inline Iterator begin() const noexcept {
+      return Iterator{*table_, first_};
+    }
+    inline Iterator end() const noexcept { return Iterator{*table_, last_}; }
+    inline size_t size() const noexcept { return last_ - first_; }
+    inline bool empty() const noexcept { return first_ == last_; }
+
+  private:
+    const SupportTable *table_;
+    size_t first_;
+    size_t last_;
   };
 
   explicit Support(const normalized::Problem &problem, util::Seconds timeout);
@@ -49,53 +142,76 @@ public:
     return num_ground_atoms_;
   }
 
+  // Ground atoms are numbered densely in mixed radix: the atoms of each
+  // predicate start at its offset and each argument contributes its index
+  // within the parameter type times the stride of the parameter
   inline PredicateId get_id(const normalized::GroundAtom &atom) const noexcept {
-    auto [it, success] = ground_atoms_.try_emplace(atom, ground_atoms_.size());
-    assert(it->second < num_ground_atoms_);
-    return it->second;
-  }
-
-  inline const auto &get_condition_supports() const noexcept {
-    return condition_supports_;
+    const auto &types = problem_.predicates[atom.predicate].parameter_types;
+    const auto &strides = strides_[atom.predicate];
+    size_t id = predicate_offsets_[atom.predicate];
+    for (size_t i = 0; i < atom.arguments.size(); ++i) {
+      id += constant_indices_[types[i]][atom.arguments[i]] * strides[i];
+    }
+    assert(id < num_ground_atoms_);
+    return id;
   }
 
-  inline const auto &get_support(PredicateId id, bool positive,
+  inline SupportSpan get_support(PredicateId id, bool positive,
                                  bool is_effect) const noexcept {
-    return positive ? is_effect ? condition_supports_[id].pos_effect
-                                : condition_supports_[id].pos_precondition
-                    : is_effect ? condition_supports_[id].neg_effect
-                                : condition_supports_[id].neg_precondition;
+    const auto &table = select_support(positive, is_effect);
+    return SupportSpan{table, table.offsets[id], table.offsets[id + 1]};
   }
 
-  inline bool is_init(PredicateId id) const noexcept {
-    return init_.find(id) != init_.end();
-  }
+  inline bool is_init(PredicateId id) const noexcept { return init_[id]; }
 
   bool is_rigid(PredicateId id, bool positive) const noexcept {
-    return (positive ? condition_supports_[id].neg_effect.empty()
-                     : condition_supports_[id].pos_effect.empty()) &&
-           is_init(id) == positive;
+    return get_support(id, !positive, true).empty() && is_init(id) == positive;
   }
 
 private:
-  inline auto &select_support(PredicateId id, bool positive,
-                              bool is_effect) noexcept {
-    return positive ? is_effect ? condition_supports_[id].pos_effect
-                                : condition_supports_[id].pos_precondition
-                    : is_effect ? condition_supports_[id].neg_effect
-                                : condition_supports_[id].neg_precondition;
+  static inline size_t get_table_index(bool positive,
+                                       bool is_effect) noexcept {
+    return 2 * static_cast<size_t>(positive) + static_cast<size_t>(is_effect);
+  }
+
+  inline const SupportTable &select_support(bool positive,
+                                            bool is_effect) const noexcept {
+    return supports_[get_table_index(positive, is_effect)];
   }
 
+  // Calls f(id, positive, is_effect, action_index, assignment) for every
+  // support of every ground atom in a fixed order
+  template <typename F> void for_each_support(F &&f);
+  void set_ground_atom_ids();
   void set_predicate_support();
 
   util::Timer timer_;
   util::Seconds timeout_;
-  size_t num_ground_atoms_;
-  std::unordered_set<PredicateId> init_;
-  mutable std::unordered_map<normalized::GroundAtom, PredicateId> ground_atoms_;
-  std::vector<ConditionSupport> condition_supports_;
+  size_t num_ground_atoms_ = 0;
+  std::vector<size_t> predicate_offsets_;
+  std::vector<std::vector<size_t>> strides_;
+  // Index of each constant within the constants of a type, only set for the
+  // types of predicate parameters
+  std::vector<std::vector<size_t>> constant_indices_;
+  std::vector<bool> init_;
+  std::array<SupportTable, 4> supports_;
 
   const normalized::Problem &problem_;
 };
 
+namespace std {
+
+template <> struct hash<Support::Assignment> {
+  size_t operator()(const Support::Assignment &assignment) const noexcept {
+    size_t h = hash<size_t>{}(assignment.size());
+    for (const auto &[parameter_index, constant] : assignment) {
+      h ^= hash<normalized::ParameterIndex>{}(parameter_index);
+      h ^= hash<normalized::ConstantIndex>{}(constant);
+    }
+    return h;
+  }
+};
+
+} // namespace std
+
 #endif /* end of include guard: SUPPORT_HPP */
@@ -1,9 +1,30 @@
 #include "engine/engine.hpp"
+#include "encoder/encoder.hpp"
+#include "encoder/encoding_cache.hpp"
 #include "planner/sat_planner.hpp"
 
 Engine::Engine(const std::shared_ptr<normalized::Problem> &problem)
-    : problem_{problem} {}
+    : problem_{problem} {
+  if (config.encoding_cache) {
+    encoding_cache_.emplace(problem_);
+  }
+}
 
 Plan Engine::start_planning() {
+  if (encoding_cache_) {
+    if (auto encoder = encoding_cache_->load()) {
+      encoder->encode();
+      SatPlanner planner{};
+      planner.set_encoder(std::move(encoder));
+      LOG_INFO(engine_logger, "Planner started with cached encoding");
+      return planner.find_plan(problem_, util::inf_time);
+    }
+  }
   return start_planning_impl();
 }
+
+void Engine::cache_encoding(const Encoder &encoder) const {
+  if (encoding_cache_) {
+    encoding_cache_->store(encoder);
+  }
+}
@@ -2,11 +2,14 @@
 #define ENGINE_HPP
 
 #include "config.hpp"
+#include "encoder/encoder.hpp"
+#include "encoder/encoding_cache.hpp"
 #include "logging/logging.hpp"
 #include "model/normalized/model.hpp"
 #include "planner/sat_planner.hpp"
 
 #include <memory>
+#include <optional>
 
 extern logging::Logger engine_logger;
 
@@ -19,7 +22,12 @@ public:
   virtual ~Engine() = default;
 
 protected:
+  // Stores the encoding if an encoding cache is configured. A later run on
+  // the same problem then skips grounding and encoding.
+  void cache_encoding(const Encoder &encoder) const;
+
   std::shared_ptr<normalized::Problem> problem_;
+  std::optional<EncodingCache> encoding_cache_;
 
 private:
   virtual Plan start_planning_impl() = 0;
@@ -19,12 +19,27 @@ Plan FixedEngine::start_planning_impl() {
 
   grounder.refine(config.target_groundness, config.grounding_timeout);
 
+  if (grounder.is_unsolvable()) {
+    throw UnsolvableException{};
+  }
+
   LOG_INFO(engine_logger, "Groundness of %.3f resulting in %lu actions",
            grounder.get_groundness(), grounder.get_num_actions());
 
   auto problem = grounder.extract_problem();
 
   SatPlanner planner{};
+  if (encoding_cache_) {
+    auto encoder = SatPlanner::get_encoder(problem, util::inf_time);
+    try {
+      encoder->encode();
+    } catch (const TimeoutException &e) {
+      LOG_ERROR(engine_logger, "Encoding timed out");
+      throw;
+    }
+    cache_encoding(*encoder);
+    planner.set_encoder(std::move(encoder));
+  }
 
   LOG_INFO(engine_logger, "Planner started with no timeout");
 
@@ -15,6 +15,10 @@ Plan InterruptEngine::start_planning_impl() {
 
   Grounder grounder{problem_};
 
+  if (grounder.is_unsolvable()) {
+    throw UnsolvableException{};
+  }
+
   LOG_INFO(engine_logger, "Targeting %.3f groundness", 0.f);
   LOG_INFO(engine_logger,
            "Grounding to %.3f groundness resulting in %lu actions",
@@ -48,6 +52,10 @@ Plan InterruptEngine::start_planning_impl() {
 
     grounder.refine(next_groundness, config.grounding_timeout);
 
+    if (grounder.is_unsolvable()) {
+      throw UnsolvableException{};
+    }
+
     LOG_INFO(engine_logger,
              "Grounding to %.3f groundness resulting in %lu actions",
              grounder.get_groundness(), grounder.get_num_actions());
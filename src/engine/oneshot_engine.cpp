@@ -17,6 +17,10 @@ Plan OneshotEngine::start_planning_impl() {
 
   util::Timer timer;
   Grounder grounder{problem_};
+  if (grounder.is_unsolvable()) {
+    throw UnsolvableException{};
+  }
+
   auto smallest_problem = grounder.extract_problem();
   std::unique_ptr<Encoder> smallest_encoder{};
   uint_fast64_t min_encoding_size = std::numeric_limits<uint_fast64_t>::max();
@@ -31,10 +35,11 @@ Plan OneshotEngine::start_planning_impl() {
         smallest_problem,
         std::min(util::Seconds{10}, util::Seconds{config.grounding_timeout -
                                                   timer.get_elapsed_time()}));
-    encoder->encode();
-    auto encoding_size = encoder->get_num_vars();
-    LOG_INFO(engine_logger, "Encoding as %lu clauses", encoding_size);
-    min_encoding_size = encoding_size;
+    auto encoding_size = encoder->estimate_size();
+    LOG_INFO(engine_logger,
+             "Encoding estimated with %lu variables and %lu clauses per step",
+             encoding_size.num_vars, encoding_size.get_num_clauses());
+    min_encoding_size = encoding_size.get_size();
     smallest_encoder = std::move(encoder);
     min_grounding = grounder.get_groundness();
   } catch (const TimeoutException &e) {
@@ -56,6 +61,10 @@ Plan OneshotEngine::start_planning_impl() {
     grounder.refine(next_groundness,
                     config.grounding_timeout - timer.get_elapsed_time());
 
+    if (grounder.is_unsolvable()) {
+      throw UnsolvableException{};
+    }
+
     if (config.grounding_timeout != util::inf_time &&
         timer.get_elapsed_time() > config.grounding_timeout) {
       break;
@@ -70,11 +79,12 @@ Plan OneshotEngine::start_planning_impl() {
           problem,
           std::min(util::Seconds{10}, util::Seconds{config.grounding_timeout -
                                                     timer.get_elapsed_time()}));
-      encoder->encode();
-      auto encoding_size = encoder->get_num_vars();
-      LOG_INFO(engine_logger, "Encoding as %lu clauses", encoding_size);
-      if (encoding_size < min_encoding_size) {
-        min_encoding_size = encoding_size;
+      auto encoding_size = encoder->estimate_size();
+      LOG_INFO(engine_logger,
+               "Encoding estimated with %lu variables and %lu clauses per step",
+               encoding_size.num_vars, encoding_size.get_num_clauses());
+      if (encoding_size.get_size() < min_encoding_size) {
+        min_encoding_size = encoding_size.get_size();
         smallest_encoder = std::move(encoder);
         smallest_problem = std::move(problem);
         min_grounding = grounder.get_groundness();
@@ -89,6 +99,16 @@ Plan OneshotEngine::start_planning_impl() {
              "Smallest encoding with size %lu by problem with %.3f groundness",
              min_encoding_size, min_grounding);
 
+    // Only the selected encoding is generated, without the time limit for
+    // comparing the groundness levels
+    smallest_encoder->set_timeout(util::inf_time);
+    try {
+      smallest_encoder->encode();
+    } catch (const TimeoutException &e) {
+      LOG_ERROR(engine_logger, "Encoding timed out");
+      throw;
+    }
+    cache_encoding(*smallest_encoder);
     planner.set_encoder(std::move(smallest_encoder));
   } else if (grounder.get_groundness() == 1.0f) {
     smallest_problem = grounder.extract_problem();
@@ -0,0 +1,129 @@
+#ifndef ATOM_CACHE_HPP
+#define ATOM_CACHE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_set>
+#include <vector>
+
+// Ground atoms of a predicate are identified by their mixed radix index, see
+// Grounder::get_id. Up to this many ids, the structures below use bitmaps
+// instead of hashing.
+inline constexpr uint_fast64_t max_dense_atom_ids = uint_fast64_t{1} << 22;
+
+// Number of ids of a predicate with the given arity, saturating on overflow
+inline uint_fast64_t get_num_atom_ids(size_t arity,
+                                      size_t num_constants) noexcept {
+  uint_fast64_t num_ids = 1;
+  for (size_t i = 0; i < arity; ++i) {
+    if (num_constants > 0 &&
+        num_ids > std::numeric_limits<uint_fast64_t>::max() / num_constants) {
+      return std::numeric_limits<uint_fast64_t>::max();
+    }
+    num_ids *= num_constants;
+  }
+  return num_ids;
+}
+
+// Set of ground atoms of a predicate
+class AtomSet {
+public:
+  AtomSet() = default;
+
+  AtomSet(uint_fast64_t num_ids, std::vector<uint_fast64_t> ids)
+      : dense_{num_ids <= max_dense_atom_ids} {
+    if (dense_) {
+      bits_.resize((num_ids + 63) / 64, 0);
+      for (auto id : ids) {
+        bits_[id / 64] |= uint64_t{1} << (id % 64);
+      }
+    } else {
+      std::sort(ids.begin(), ids.end());
+      ids_ = std::move(ids);
+    }
+  }
+
+  bool contains(uint_fast64_t id) const noexcept {
+    if (dense_) {
+      return ((bits_[id / 64] >> (id % 64)) & 1) == 1;
+    }
+    return std::binary_search(ids_.begin(), ids_.end(), id);
+  }
+
+private:
+  bool dense_ = true;
+  std::vector<uint64_t> bits_;
+  std::vector<uint_fast64_t> ids_;
+};
+
+// Cached boolean property of the ground atoms of a predicate with two bits
+// per atom, falling back to hash sets for large id spaces
+class AtomCache {
+public:
+  enum class Result : uint64_t { Unknown = 0, True = 1, False = 2 };
+
+  AtomCache() = default;
+
+  explicit AtomCache(uint_fast64_t num_ids)
+      : dense_{num_ids <= max_dense_atom_ids} {
+    if (dense_) {
+      bits_.resize((num_ids + 31) / 32, 0);
+    }
+  }
+
+  Result get(uint_fast64_t id) const noexcept {
+    if (dense_) {
+      return static_cast<Result>((bits_[id / 32] >> (2 * (id % 32))) & 3);
+    }
+    if (true_.find(id) != true_.end()) {
+      return Result::True;
+    }
+    if (false_.find(id) != false_.end()) {
+      return Result::False;
+    }
+    return Result::Unknown;
+  }
+
+  void set(uint_fast64_t id, bool value) {
+    if (dense_) {
+      auto shift = 2 * (id % 32);
+      auto &word = bits_[id / 32];
+      if (value && ((word >> shift) & 3) != 1) {
+        ++num_true_;
+      }
+      word = (word & ~(uint64_t{3} << shift)) |
+             (static_cast<uint64_t>(value ? Result::True : Result::False)
+              << shift);
+    } else if (value) {
+      if (true_.insert(id).second) {
+        ++num_true_;
+      }
+    } else {
+      false_.insert(id);
+    }
+  }
+
+  // False results may become outdated when actions are pruned
+  void clear_false() noexcept {
+    if (dense_) {
+      // Keeps the lower bit of each entry, which is only set for True
+      for (auto &word : bits_) {
+        word &= 0x5555555555555555;
+      }
+    } else {
+      false_.clear();
+    }
+  }
+
+  size_t get_num_true() const noexcept { return num_true_; }
+
+private:
+  bool dense_ = true;
+  std::vector<uint64_t> bits_;
+  std::unordered_set<uint_fast64_t> true_;
+  std::unordered_set<uint_fast64_t> false_;
+  size_t num_true_ = 0;
+};
+
+#endif /* end of include guard: ATOM_CACHE_HPP */
@@ -0,0 +1,315 @@
+#include "grounder/datalog_grounder.hpp"
+#include "logging/logging.hpp"
+#include "model/normalized/model.hpp"
+#include "planner/planner.hpp"
+#include "util/timer.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+using namespace normalized;
+
+size_t DatalogGrounder::ArgumentsHash::operator()(
+    const Arguments &arguments) const noexcept {
+  size_t h = arguments.size();
+  for (auto c : arguments) {
+    h ^= std::hash<ConstantIndex>{}(c) + 0x9e3779b9 + (h << 6) + (h >> 2);
+  }
+  return h;
+}
+
+DatalogGrounder::DatalogGrounder(const Problem &problem) noexcept
+    : relations_(problem.predicates.size()), rules_(problem.actions.size()),
+      of_type_(problem.types.size(),
+               std::vector<bool>(problem.constants.size(), false)),
+      actions_(problem.actions.size()), problem_{problem} {
+  for (size_t i = 0; i < problem_.predicates.size(); ++i) {
+    relations_[i].index.resize(problem_.predicates[i].parameter_types.size());
+  }
+
+  for (size_t t = 0; t < problem_.types.size(); ++t) {
+    for (auto c : problem_.constants_of_type[t]) {
+      of_type_[t][c] = true;
+    }
+  }
+
+  auto as_atom = [](const GroundAtom &atom) {
+    Atom result{atom.predicate, {}};
+    result.arguments.reserve(atom.arguments.size());
+    for (auto c : atom.arguments) {
+      result.arguments.emplace_back(c);
+    }
+    return result;
+  };
+
+  for (size_t i = 0; i < problem_.actions.size(); ++i) {
+    const auto &action = problem_.actions[i];
+    auto &rule = rules_[i];
+    rule.parameters = action.parameters;
+    for (const auto &precondition : action.preconditions) {
+      if (precondition.positive) {
+        rule.body.push_back(precondition.atom);
+      }
+    }
+    for (const auto &[precondition, positive] : action.ground_preconditions) {
+      if (positive) {
+        rule.body.push_back(as_atom(precondition));
+      }
+    }
+    for (const auto &effect : action.effects) {
+      if (effect.positive) {
+        rule.head.push_back(effect.atom);
+      }
+    }
+    for (const auto &[effect, positive] : action.ground_effects) {
+      if (positive) {
+        rule.head.push_back(as_atom(effect));
+      }
+    }
+  }
+
+  for (const auto &atom : problem_.init) {
+    add_atom(atom.predicate, atom.arguments);
+  }
+}
+
+std::optional<std::vector<std::vector<DatalogGrounder::Arguments>>>
+DatalogGrounder::ground(util::Seconds timeout) {
+  util::Timer timer;
+
+  // Rules without positive preconditions fire exactly once
+  for (size_t i = 0; i < rules_.size(); ++i) {
+    if (rules_[i].body.empty()) {
+      auto binding = get_initial_binding(rules_[i]);
+      assign_free(i, 0, binding);
+    }
+  }
+
+  uint_fast64_t round = 0;
+  while (commit_round()) {
+    ++round;
+    for (size_t i = 0; i < rules_.size(); ++i) {
+      if (timeout != util::inf_time && timer.get_elapsed_time() > timeout) {
+        return std::nullopt;
+      }
+      if (config.timeout != util::inf_time &&
+          global_timer.get_elapsed_time() > config.timeout) {
+        throw TimeoutException{};
+      }
+      const auto &body = rules_[i].body;
+      std::vector<bool> joined(body.size(), false);
+      for (size_t d = 0; d < body.size(); ++d) {
+        const auto &relation = relations_[body[d].predicate];
+        auto binding = get_initial_binding(rules_[i]);
+        std::vector<size_t> newly_bound;
+        joined[d] = true;
+        for (size_t f = relation.delta_begin; f < relation.atoms.size(); ++f) {
+          if (match(body[d], relation.atoms[f], rules_[i], binding,
+                    newly_bound)) {
+            join(i, d, joined, 1, binding);
+            for (auto p : newly_bound) {
+              binding.bound[p] = false;
+            }
+            newly_bound.clear();
+          }
+        }
+        joined[d] = false;
+      }
+    }
+  }
+
+  LOG_DEBUG(grounder_logger, "Reached fixpoint after %lu rounds", round);
+  return std::move(actions_);
+}
+
+void DatalogGrounder::add_atom(PredicateIndex predicate, Arguments arguments) {
+  auto &relation = relations_[predicate];
+  if (relation.derived.insert(arguments).second) {
+    relation.pending.push_back(std::move(arguments));
+  }
+}
+
+bool DatalogGrounder::commit_round() {
+  bool has_delta = false;
+  for (auto &relation : relations_) {
+    relation.delta_begin = relation.atoms.size();
+    for (auto &arguments : relation.pending) {
+      for (size_t i = 0; i < arguments.size(); ++i) {
+        relation.index[i][arguments[i]].push_back(relation.atoms.size());
+      }
+      relation.atoms.push_back(std::move(arguments));
+    }
+    has_delta |= !relation.pending.empty();
+    relation.pending.clear();
+  }
+  return has_delta;
+}
+
+DatalogGrounder::Binding
+DatalogGrounder::get_initial_binding(const Rule &rule) const noexcept {
+  Binding binding{Arguments(rule.parameters.size()),
+                  std::vector<bool>(rule.parameters.size(), false)};
+  for (size_t p = 0; p < rule.parameters.size(); ++p) {
+    if (!rule.parameters[p].is_free()) {
+      binding.constants[p] = rule.parameters[p].get_constant();
+      binding.bound[p] = true;
+    }
+  }
+  return binding;
+}
+
+bool DatalogGrounder::match(const Atom &atom, const Arguments &arguments,
+                            const Rule &rule, Binding &binding,
+                            std::vector<size_t> &newly_bound) const noexcept {
+  auto num_bound = newly_bound.size();
+  for (size_t i = 0; i < arguments.size(); ++i) {
+    const auto &argument = atom.arguments[i];
+    bool matches = true;
+    if (!argument.is_parameter()) {
+      matches = argument.get_constant() == arguments[i];
+    } else if (auto p = argument.get_parameter_index(); binding.bound[p]) {
+      matches = binding.constants[p] == arguments[i];
+    } else if (of_type_[rule.parameters[p].get_type()][arguments[i]]) {
+      binding.constants[p] = arguments[i];
+      binding.bound[p] = true;
+      newly_bound.push_back(p);
+    } else {
+      matches = false;
+    }
+    if (!matches) {
+      for (auto j = num_bound; j < newly_bound.size(); ++j) {
+        binding.bound[newly_bound[j]] = false;
+      }
+      newly_bound.resize(num_bound);
+      return false;
+    }
+  }
+  return true;
+}
+
+const DatalogGrounder::Positions *
+DatalogGrounder::get_candidates(const Atom &atom,
+                                const Binding &binding) const noexcept {
+  static const Positions no_positions;
+  const auto &relation = relations_[atom.predicate];
+  const Positions *candidates = nullptr;
+  for (size_t i = 0; i < atom.arguments.size(); ++i) {
+    const auto &argument = atom.arguments[i];
+    std::optional<ConstantIndex> constant;
+    if (!argument.is_parameter()) {
+      constant = argument.get_constant();
+    } else if (auto p = argument.get_parameter_index(); binding.bound[p]) {
+      constant = binding.constants[p];
+    }
+    const Positions *positions = nullptr;
+    if (constant) {
+      auto it = relation.index[i].find(*constant);
+      positions = it != relation.index[i].end() ? &it->second : &no_positions;
+    }
+    if (positions != nullptr &&
+        (candidates == nullptr || positions->size() < candidates->size())) {
+      candidates = positions;
+    }
+  }
+  return candidates;
+}
+
+void DatalogGrounder::join(size_t rule, size_t delta,
+                           std::vector<bool> &joined, size_t num_joined,
+                           Binding &binding) {
+  const auto &body = rules_[rule].body;
+  if (num_joined == body.size()) {
+    assign_free(rule, 0, binding);
+    return;
+  }
+
+  // Join the atom with the fewest candidates next
+  size_t next = body.size();
+  const Positions *candidates = nullptr;
+  auto num_candidates = std::numeric_limits<size_t>::max();
+  for (size_t k = 0; k < body.size(); ++k) {
+    if (joined[k]) {
+      continue;
+    }
+    auto positions = get_candidates(body[k], binding);
+    auto size = positions != nullptr
+                    ? positions->size()
+                    : relations_[body[k].predicate].atoms.size();
+    if (size < num_candidates) {
+      next = k;
+      candidates = positions;
+      num_candidates = size;
+    }
+  }
+  if (num_candidates == 0) {
+    return;
+  }
+
+  const auto &relation = relations_[body[next].predicate];
+  auto end = next < delta ? relation.delta_begin : relation.atoms.size();
+  std::vector<size_t> newly_bound;
+  auto visit = [&](uint_fast64_t f) {
+    if (match(body[next], relation.atoms[f], rules_[rule], binding,
+              newly_bound)) {
+      join(rule, delta, joined, num_joined + 1, binding);
+      for (auto p : newly_bound) {
+        binding.bound[p] = false;
+      }
+      newly_bound.clear();
+    }
+  };
+  joined[next] = true;
+  if (candidates != nullptr) {
+    // Positions are sorted as atoms are only appended
+    for (auto f : *candidates) {
+      if (f >= end) {
+        break;
+      }
+      visit(f);
+    }
+  } else {
+    for (uint_fast64_t f = 0; f < end; ++f) {
+      visit(f);
+    }
+  }
+  joined[next] = false;
+}
+
+void DatalogGrounder::assign_free(size_t rule, size_t parameter,
+                                  Binding &binding) {
+  const auto &parameters = rules_[rule].parameters;
+  if (parameter == parameters.size()) {
+    fire(rule, binding);
+    return;
+  }
+  if (binding.bound[parameter]) {
+    assign_free(rule, parameter + 1, binding);
+    return;
+  }
+  binding.bound[parameter] = true;
+  for (auto c : problem_.constants_of_type[parameters[parameter].get_type()]) {
+    binding.constants[parameter] = c;
+    assign_free(rule, parameter + 1, binding);
+  }
+  binding.bound[parameter] = false;
+}
+
+void DatalogGrounder::fire(size_t rule, const Binding &binding) {
+  actions_[rule].push_back(binding.constants);
+  for (const auto &atom : rules_[rule].head) {
+    Arguments arguments;
+    arguments.reserve(atom.arguments.size());
+    for (const auto &argument : atom.arguments) {
+      if (argument.is_parameter()) {
+        arguments.push_back(binding.constants[argument.get_parameter_index()]);
+      } else {
+        arguments.push_back(argument.get_constant());
+      }
+    }
+    add_atom(atom.predicate, std::move(arguments));
+  }
+}
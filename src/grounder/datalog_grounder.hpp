@@ -0,0 +1,89 @@
+#ifndef DATALOG_GROUNDER_HPP
+#define DATALOG_GROUNDER_HPP
+
+#include "config.hpp"
+#include "logging/logging.hpp"
+#include "model/normalized/model.hpp"
+#include "util/timer.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+extern logging::Logger grounder_logger;
+extern Config config;
+extern util::Timer global_timer;
+
+// Computes the ground actions reachable from the initial state when ignoring
+// negative preconditions and delete effects. Each action schema is a rule from
+// its positive preconditions to its positive effects. The rules are evaluated
+// semi-naively, so each round only joins instances using at least one atom
+// derived in the previous round. Preconditions before the first such atom are
+// only joined with older atoms, so each instance is derived exactly once.
+class DatalogGrounder {
+public:
+  using Arguments = std::vector<normalized::ConstantIndex>;
+
+  explicit DatalogGrounder(const normalized::Problem &problem) noexcept;
+
+  // Arguments of the reachable ground actions, indexed by schema, or
+  // std::nullopt if the timeout was hit
+  std::optional<std::vector<std::vector<Arguments>>>
+  ground(util::Seconds timeout);
+
+private:
+  using Positions = std::vector<uint_fast64_t>;
+
+  struct ArgumentsHash {
+    size_t operator()(const Arguments &arguments) const noexcept;
+  };
+
+  // Derived atoms of a predicate in order of derivation. The atoms derived in
+  // the previous round start at delta_begin.
+  struct Relation {
+    std::vector<Arguments> atoms;
+    std::unordered_set<Arguments, ArgumentsHash> derived;
+    std::vector<Arguments> pending;
+    size_t delta_begin = 0;
+    // Positions in atoms by argument position and constant. Only constants
+    // occurring at a position have an entry.
+    std::vector<std::unordered_map<normalized::ConstantIndex, Positions>> index;
+  };
+
+  struct Rule {
+    std::vector<normalized::Atom> body;
+    std::vector<normalized::Atom> head;
+    std::vector<normalized::Parameter> parameters;
+  };
+
+  // Variable assignment of the rule that is currently joined
+  struct Binding {
+    Arguments constants;
+    std::vector<bool> bound;
+  };
+
+  void add_atom(normalized::PredicateIndex predicate, Arguments arguments);
+  bool commit_round();
+  Binding get_initial_binding(const Rule &rule) const noexcept;
+  bool match(const normalized::Atom &atom, const Arguments &arguments,
+             const Rule &rule, Binding &binding,
+             std::vector<size_t> &newly_bound) const noexcept;
+  const Positions *
+  get_candidates(const normalized::Atom &atom,
+                 const Binding &binding) const noexcept;
+  void join(size_t rule, size_t delta, std::vector<bool> &joined,
+            size_t num_joined, Binding &binding);
+  void assign_free(size_t rule, size_t parameter, Binding &binding);
+  void fire(size_t rule, const Binding &binding);
+
+  std::vector<Relation> relations_;
+  std::vector<Rule> rules_;
+  // Whether a constant is of a type, indexed by type and constant
+  std::vector<std::vector<bool>> of_type_;
+  std::vector<std::vector<Arguments>> actions_;
+  const normalized::Problem &problem_;
+};
+
+#endif /* end of include guard: DATALOG_GROUNDER_HPP */
@@ -1,4 +1,5 @@
 #include "grounder/grounder.hpp"
+#include "grounder/datalog_grounder.hpp"
 #include "logging/logging.hpp"
 #include "model/normalized/model.hpp"
 #include "model/normalized/utils.hpp"
@@ -8,9 +9,11 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <numeric>
-#include <unordered_set>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -19,10 +22,7 @@ using namespace normalized;
 Grounder::Grounder(const std::shared_ptr<Problem> &problem) noexcept
     : trivially_rigid_(problem->predicates.size(), true),
       trivially_useless_(problem->predicates.size(), true),
-      init_(problem->predicates.size()), goal_(problem->predicates.size()),
-      action_grounded_(problem->actions.size(), false),
-      successful_cache_(problem->predicates.size()),
-      unsuccessful_cache_(problem->predicates.size()), problem_{problem} {
+      action_grounded_(problem->actions.size(), false), problem_{problem} {
   num_actions_ =
       std::accumulate(problem_->actions.begin(), problem_->actions.end(), 0ul,
                       [this](uint_fast64_t sum, const auto &a) {
@@ -44,27 +44,72 @@ Grounder::Grounder(const std::shared_ptr<Problem> &problem) noexcept
     }
   }
 
-  for (const auto &init : problem_->init) {
-    init_[init.predicate].push_back(get_id(init));
+  std::vector<std::vector<uint_fast64_t>> init(problem_->predicates.size());
+  for (const auto &atom : problem_->init) {
+    init[atom.predicate].push_back(get_id(atom));
   }
-  for (auto &i : init_) {
-    std::sort(i.begin(), i.end());
+  std::vector<std::vector<uint_fast64_t>> goal(problem_->predicates.size());
+  for (const auto &[atom, positive] : problem_->goal) {
+    goal[atom.predicate].push_back(get_id(atom));
   }
-
-  for (const auto &[goal, positive] : problem_->goal) {
-    goal_[goal.predicate].push_back(get_id(goal));
+  rigid_init_.resize(problem_->predicates.size());
+  for (const auto &atom : problem_->init) {
+    if (trivially_rigid_[atom.predicate]) {
+      rigid_init_[atom.predicate].push_back(atom);
+    }
   }
-  for (auto &g : goal_) {
-    std::sort(g.begin(), g.end());
+
+  init_.reserve(problem_->predicates.size());
+  goal_.reserve(problem_->predicates.size());
+  cache_.reserve(problem_->predicates.size());
+  for (size_t i = 0; i < problem_->predicates.size(); ++i) {
+    auto num_ids =
+        get_num_atom_ids(problem_->predicates[i].parameter_types.size(),
+                         problem_->constants.size());
+    init_.emplace_back(num_ids, std::move(init[i]));
+    goal_.emplace_back(num_ids, std::move(goal[i]));
+    cache_.push_back(
+        Cache{AtomCache{num_ids}, AtomCache{num_ids}, AtomCache{num_ids}});
   }
 
+  schemas_.reserve(problem_->actions.size());
   actions_.reserve(problem_->actions.size());
 
+  auto as_condition = [](const GroundAtom &atom, bool positive) {
+    Condition condition{Atom{atom.predicate, {}}, positive};
+    condition.atom.arguments.reserve(atom.arguments.size());
+    for (auto c : atom.arguments) {
+      condition.atom.arguments.emplace_back(c);
+    }
+    return condition;
+  };
+
   for (const auto &action : problem_->actions) {
-    actions_.push_back({action});
+    Schema schema{action.preconditions, action.effects};
+    for (const auto &[precondition, positive] : action.ground_preconditions) {
+      schema.preconditions.push_back(as_condition(precondition, positive));
+    }
+    for (const auto &[effect, positive] : action.ground_effects) {
+      schema.effects.push_back(as_condition(effect, positive));
+    }
+    actions_.push_back({PartialAction{
+        action.parameters,
+        std::vector<bool>(schema.preconditions.size() + schema.effects.size(),
+                          false)}});
+    schemas_.push_back(std::move(schema));
   }
 
-  prune_actions();
+  materialized_.resize(actions_.size());
+  condition_index_.resize(
+      problem_->predicates.size(),
+      ConditionIndex{std::vector<Positions>(actions_.size()),
+                     std::vector<Positions>(actions_.size()),
+                     std::vector<Positions>(actions_.size())});
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    update_condition_index(i);
+  }
+
+  prune();
 
   groundness_ = static_cast<float>(get_num_actions() + num_pruned_actions_) /
                 static_cast<float>(num_actions_);
@@ -119,6 +164,12 @@ bool Grounder::is_useless(const GroundAtom &atom) const noexcept {
 void Grounder::refine(float groundness, util::Seconds timeout) {
   util::Timer timer;
 
+  if (config.pruning_policy == Config::PruningPolicy::Datalog &&
+      groundness >= 1.0f && groundness_ < 1.0f) {
+    ground_reachable(timeout);
+    return;
+  }
+
   while (groundness_ < groundness) {
     LOG_INFO(grounder_logger, "Current groundness: %.3f", groundness_);
     LOG_INFO(grounder_logger, "Current actions: %lu actions",
@@ -129,7 +180,7 @@ void Grounder::refine(float groundness, util::Seconds timeout) {
         continue;
       }
       bool action_grounded = true;
-      std::vector<Action> new_actions;
+      std::vector<PartialAction> new_actions;
       uint_fast64_t new_pruned_actions = 0;
       for (const auto &action : actions_[i]) {
         if (timeout != util::inf_time && timer.get_elapsed_time() > timeout) {
@@ -139,17 +190,31 @@ void Grounder::refine(float groundness, util::Seconds timeout) {
             global_timer.get_elapsed_time() > config.timeout) {
           throw TimeoutException{};
         }
-        auto selection = std::invoke(parameter_selector_, *this, action);
+        auto full_action = materialize(i, action);
+        auto selection = std::invoke(parameter_selector_, *this, full_action);
         if (!selection.empty()) {
           action_grounded = false;
         }
-        for (auto it = AssignmentIterator{selection, action, *problem_};
-             it != AssignmentIterator{}; ++it) {
-          auto [new_action, valid] = ground(action, *it);
+        // Assignments violating the constraints are pruned without being
+        // enumerated
+        auto num_selected =
+            get_num_instantiated(selection, full_action, *problem_);
+        auto num_per_assignment =
+            num_selected == 0
+                ? 0
+                : get_num_instantiated(action.parameters, *problem_) /
+                      num_selected;
+        new_pruned_actions += num_selected * num_per_assignment;
+        auto constraints = get_constraints(i, action, selection);
+        for (auto it = ConstrainedAssignmentIterator{selection, constraints};
+             it != ConstrainedAssignmentIterator{}; ++it) {
+          new_pruned_actions -= num_per_assignment;
+          auto [new_action, valid] = ground(i, action, *it);
           if (valid) {
-            new_actions.push_back(new_action);
+            new_actions.push_back(std::move(new_action));
           } else {
-            new_pruned_actions += get_num_instantiated(new_action, *problem_);
+            new_pruned_actions +=
+                get_num_instantiated(new_action.parameters, *problem_);
           }
         }
       }
@@ -160,6 +225,7 @@ void Grounder::refine(float groundness, util::Seconds timeout) {
       }
       num_pruned_actions_ += new_pruned_actions;
       actions_[i] = std::move(new_actions);
+      update_condition_index(i);
       groundness_ =
           static_cast<float>(get_num_actions() + num_pruned_actions_) /
           static_cast<float>(num_actions_);
@@ -170,7 +236,7 @@ void Grounder::refine(float groundness, util::Seconds timeout) {
     if (!keep_grounding) {
       return;
     }
-    prune_actions();
+    prune();
   }
 }
 
@@ -184,6 +250,12 @@ size_t Grounder::get_num_actions() const noexcept {
 
 float Grounder::get_groundness() const noexcept { return groundness_; }
 
+bool Grounder::is_unsolvable() const noexcept {
+  return std::any_of(
+      problem_->goal.begin(), problem_->goal.end(),
+      [this](const auto &g) { return is_rigid(g.first, !g.second); });
+}
+
 Grounder::PredicateId Grounder::get_id(const GroundAtom &atom) const noexcept {
   uint_fast64_t result = 0;
   for (const auto &a : atom.arguments) {
@@ -192,59 +264,306 @@ Grounder::PredicateId Grounder::get_id(const GroundAtom &atom) const noexcept {
   return result;
 }
 
+Grounder::PredicateId Grounder::get_id(const Atom &atom,
+                                       const PartialAction &action) const
+    noexcept {
+  uint_fast64_t result = 0;
+  for (const auto &a : atom.arguments) {
+    auto constant =
+        a.is_parameter()
+            ? action.parameters[a.get_parameter_index()].get_constant()
+            : a.get_constant();
+    result = (result * problem_->constants.size()) + constant;
+  }
+  return result;
+}
+
 bool Grounder::is_trivially_rigid(const GroundAtom &atom, bool positive) const
     noexcept {
-  if (std::binary_search(init_[atom.predicate].begin(),
-                         init_[atom.predicate].end(),
-                         get_id(atom)) != positive) {
+  if (init_[atom.predicate].contains(get_id(atom)) != positive) {
     return false;
   }
   return trivially_rigid_[atom.predicate];
 }
 
 bool Grounder::is_trivially_useless(const GroundAtom &atom) const noexcept {
-  auto id = get_id(atom);
-  if (std::binary_search(goal_[atom.predicate].begin(),
-                         goal_[atom.predicate].end(), id)) {
+  if (goal_[atom.predicate].contains(get_id(atom))) {
     return false;
   }
   return trivially_useless_[atom.predicate];
 }
 
-bool Grounder::has_precondition(const Action &action,
+bool Grounder::is_assigned(const Atom &atom,
+                           const PartialAction &action) const noexcept {
+  return std::all_of(
+      atom.arguments.begin(), atom.arguments.end(), [&](const auto &a) {
+        return !a.is_parameter() ||
+               !action.parameters[a.get_parameter_index()].is_free();
+      });
+}
+
+GroundAtom Grounder::get_ground_atom(const Atom &atom,
+                                     const PartialAction &action) const
+    noexcept {
+  GroundAtom ground_atom{atom.predicate, {}};
+  ground_atom.arguments.reserve(atom.arguments.size());
+  for (const auto &a : atom.arguments) {
+    ground_atom.arguments.push_back(
+        a.is_parameter()
+            ? action.parameters[a.get_parameter_index()].get_constant()
+            : a.get_constant());
+  }
+  return ground_atom;
+}
+
+bool Grounder::is_instance(const Atom &atom, const PartialAction &action,
+                           const GroundAtom &ground_atom) const noexcept {
+  for (size_t i = 0; i < atom.arguments.size(); ++i) {
+    const auto &a = atom.arguments[i];
+    auto constant = ground_atom.arguments[i];
+    if (!a.is_parameter()) {
+      if (a.get_constant() != constant) {
+        return false;
+      }
+      continue;
+    }
+    const auto &p = action.parameters[a.get_parameter_index()];
+    if (!p.is_free()) {
+      if (p.get_constant() != constant) {
+        return false;
+      }
+      continue;
+    }
+    if (!is_subtype(problem_->constants[constant].type, p.get_type(),
+                    *problem_)) {
+      return false;
+    }
+    // A free parameter has to be instantiated consistently
+    for (size_t j = 0; j < i; ++j) {
+      if (atom.arguments[j].is_parameter() &&
+          atom.arguments[j].get_parameter_index() == a.get_parameter_index() &&
+          ground_atom.arguments[j] != constant) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+Action Grounder::materialize(size_t schema,
+                             const PartialAction &action) const noexcept {
+  const auto &conditions = schemas_[schema];
+  Action result;
+  result.id = problem_->actions[schema].id;
+  result.parameters = action.parameters;
+  for (size_t i = 0; i < conditions.preconditions.size(); ++i) {
+    if (action.removed[i]) {
+      continue;
+    }
+    auto precondition = conditions.preconditions[i];
+    if (update_condition(precondition, result)) {
+      result.ground_preconditions.emplace_back(
+          as_ground_atom(precondition.atom), precondition.positive);
+    } else {
+      result.preconditions.push_back(std::move(precondition));
+    }
+  }
+  auto offset = conditions.preconditions.size();
+  for (size_t i = 0; i < conditions.effects.size(); ++i) {
+    if (action.removed[offset + i]) {
+      continue;
+    }
+    auto effect = conditions.effects[i];
+    if (update_condition(effect, result)) {
+      result.ground_effects.emplace_back(as_ground_atom(effect.atom),
+                                         effect.positive);
+    } else {
+      result.effects.push_back(std::move(effect));
+    }
+  }
+  return result;
+}
+
+bool Grounder::has_precondition(size_t schema, const PartialAction &action,
                                 const GroundAtom &atom) const noexcept {
-  for (const auto &[precondition, _] : action.ground_preconditions) {
-    if (precondition == atom) {
+  const auto &preconditions = schemas_[schema].preconditions;
+  for (size_t i = 0; i < preconditions.size(); ++i) {
+    if (!action.removed[i] &&
+        preconditions[i].atom.predicate == atom.predicate &&
+        is_instance(preconditions[i].atom, action, atom)) {
       return true;
     }
   }
-  for (const auto &precondition : action.preconditions) {
-    if (precondition.atom.predicate == atom.predicate) {
-      if (is_instantiatable(precondition.atom, atom.arguments, action,
-                            *problem_)) {
-        return true;
-      }
+  return false;
+}
+
+bool Grounder::has_effect(size_t schema, const PartialAction &action,
+                          const GroundAtom &atom, bool positive) const
+    noexcept {
+  const auto &effects = schemas_[schema].effects;
+  auto offset = schemas_[schema].preconditions.size();
+  for (size_t i = 0; i < effects.size(); ++i) {
+    if (!action.removed[offset + i] &&
+        effects[i].atom.predicate == atom.predicate &&
+        effects[i].positive == positive &&
+        is_instance(effects[i].atom, action, atom)) {
+      return true;
     }
   }
   return false;
 }
 
-bool Grounder::has_effect(const Action &action, const GroundAtom &atom,
-                          bool positive) const noexcept {
-  for (const auto &[effect, effect_positive] : action.ground_effects) {
-    if (effect == atom && effect_positive == positive) {
-      return true;
+// Rigid preconditions of the trivially rigid predicates on one or two of the
+// selected parameters restrict their domains, and the binary ones are made arc
+// consistent. Preconditions on other parameters are left to ground.
+AssignmentConstraints
+Grounder::get_constraints(size_t schema, const PartialAction &action,
+                          const ParameterSelection &selection) const
+    noexcept {
+  AssignmentConstraints constraints;
+  constraints.domains.reserve(selection.size());
+  for (auto p : selection) {
+    constraints.domains.push_back(
+        problem_->constants_of_type[action.parameters[p].get_type()]);
+    std::sort(constraints.domains.back().begin(),
+              constraints.domains.back().end());
+  }
+
+  auto get_position = [&selection](ParameterIndex p) {
+    return static_cast<size_t>(
+        std::distance(selection.begin(),
+                      std::find(selection.begin(), selection.end(), p)));
+  };
+
+  // Binary constraints in both directions, indexed by the pair of positions
+  using Values = std::unordered_map<ConstantIndex, std::vector<ConstantIndex>>;
+  std::vector<std::pair<std::pair<size_t, size_t>, Values>> binary;
+
+  const auto &preconditions = schemas_[schema].preconditions;
+  for (size_t i = 0; i < preconditions.size(); ++i) {
+    const auto &[atom, positive] = preconditions[i];
+    if (action.removed[i] || !trivially_rigid_[atom.predicate]) {
+      continue;
+    }
+    std::vector<size_t> positions;
+    bool constrained = true;
+    for (const auto &a : atom.arguments) {
+      if (!a.is_parameter() ||
+          !action.parameters[a.get_parameter_index()].is_free()) {
+        continue;
+      }
+      auto position = get_position(a.get_parameter_index());
+      if (position == selection.size()) {
+        constrained = false;
+        break;
+      }
+      if (std::find(positions.begin(), positions.end(), position) ==
+          positions.end()) {
+        positions.push_back(position);
+      }
+    }
+    if (!constrained || positions.empty() || positions.size() > 2 ||
+        (positions.size() == 2 && !positive)) {
+      continue;
+    }
+
+    // Values of the free parameters in the matching init atoms
+    std::vector<std::pair<ConstantIndex, ConstantIndex>> matches;
+    for (const auto &init : rigid_init_[atom.predicate]) {
+      std::vector<std::optional<ConstantIndex>> values(positions.size());
+      bool matching = true;
+      for (size_t k = 0; k < atom.arguments.size() && matching; ++k) {
+        const auto &a = atom.arguments[k];
+        auto constant = init.arguments[k];
+        if (!a.is_parameter()) {
+          matching = a.get_constant() == constant;
+        } else if (const auto &p = action.parameters[a.get_parameter_index()];
+                   !p.is_free()) {
+          matching = p.get_constant() == constant;
+        } else {
+          auto &value = values[static_cast<size_t>(std::distance(
+              positions.begin(),
+              std::find(positions.begin(), positions.end(),
+                        get_position(a.get_parameter_index()))))];
+          matching = !value || *value == constant;
+          value = constant;
+        }
+      }
+      if (matching) {
+        matches.emplace_back(*values.front(), *values.back());
+      }
+    }
+
+    if (positions.size() == 1) {
+      std::vector<ConstantIndex> values;
+      values.reserve(matches.size());
+      for (const auto &match : matches) {
+        values.push_back(match.first);
+      }
+      std::sort(values.begin(), values.end());
+      auto &domain = constraints.domains[positions.front()];
+      std::vector<ConstantIndex> new_domain;
+      if (positive) {
+        std::set_intersection(domain.begin(), domain.end(), values.begin(),
+                              values.end(), std::back_inserter(new_domain));
+      } else {
+        std::set_difference(domain.begin(), domain.end(), values.begin(),
+                            values.end(), std::back_inserter(new_domain));
+      }
+      domain = std::move(new_domain);
+      continue;
+    }
+
+    Values forward;
+    Values backward;
+    for (const auto &[first, second] : matches) {
+      forward[first].push_back(second);
+      backward[second].push_back(first);
     }
+    for (auto *values : {&forward, &backward}) {
+      for (auto &[constant, supported] : *values) {
+        std::sort(supported.begin(), supported.end());
+      }
+    }
+    binary.emplace_back(std::make_pair(positions[0], positions[1]),
+                        std::move(forward));
+    binary.emplace_back(std::make_pair(positions[1], positions[0]),
+                        std::move(backward));
   }
-  for (const auto &effect : action.effects) {
-    if (effect.atom.predicate == atom.predicate &&
-        effect.positive == positive) {
-      if (is_instantiatable(effect.atom, atom.arguments, action, *problem_)) {
-        return true;
+
+  // Constants without support in the domain of the other position are removed
+  // until a fixpoint is reached
+  bool changed = !binary.empty();
+  while (changed) {
+    changed = false;
+    for (const auto &[positions, values] : binary) {
+      auto &domain = constraints.domains[positions.first];
+      const auto &other_domain = constraints.domains[positions.second];
+      auto end = std::remove_if(
+          domain.begin(), domain.end(), [&](ConstantIndex constant) {
+            auto it = values.find(constant);
+            return it == values.end() ||
+                   std::none_of(it->second.begin(), it->second.end(),
+                                [&](ConstantIndex c) {
+                                  return std::binary_search(
+                                      other_domain.begin(),
+                                      other_domain.end(), c);
+                                });
+          });
+      if (end != domain.end()) {
+        domain.erase(end, domain.end());
+        changed = true;
       }
     }
   }
-  return false;
+
+  for (auto &[positions, values] : binary) {
+    if (positions.first > positions.second) {
+      constraints.supports.push_back(
+          {positions.first, positions.second, std::move(values)});
+    }
+  }
+  return constraints;
 }
 
 ParameterSelection Grounder::select_most_frequent(const Action &action) const
@@ -366,8 +685,8 @@ ParameterSelection Grounder::select_approx_max_rigid(const Action &action) const
        ++it) {
     uint_fast64_t current =
         1 + (it->positive
-                 ? successful_cache_[it->atom.predicate].neg_rigid.size()
-                 : successful_cache_[it->atom.predicate].pos_rigid.size());
+                 ? cache_[it->atom.predicate].neg_rigid.get_num_true()
+                 : cache_[it->atom.predicate].pos_rigid.get_num_true());
 
     if (current > max) {
       max = current;
@@ -389,172 +708,570 @@ ParameterSelection Grounder::select_first_effect(const Action &action) const
   }
 }
 
-void Grounder::prune_actions() noexcept {
-  bool changed;
-  do {
-    changed = false;
-    if (config.cache_policy == Config::CachePolicy::Unsuccessful) {
-      for (auto &c : unsuccessful_cache_) {
-        c.pos_rigid.clear();
-        c.neg_rigid.clear();
-        c.useless.clear();
+void Grounder::update_condition_index(size_t schema) noexcept {
+  materialized_[schema].reset();
+  for (auto &index : condition_index_) {
+    index.preconditions[schema] = Positions{};
+    index.pos_effects[schema] = Positions{};
+    index.neg_effects[schema] = Positions{};
+  }
+  const auto &conditions = schemas_[schema];
+  auto offset = conditions.preconditions.size();
+  for (size_t j = 0; j < actions_[schema].size(); ++j) {
+    const auto &action = actions_[schema][j];
+    auto add = [&](Positions &positions, const Atom &atom) {
+      if (is_assigned(atom, action)) {
+        positions.ground.emplace_back(get_id(atom, action), j);
+      } else if (positions.lifted.empty() || positions.lifted.back() != j) {
+        positions.lifted.push_back(j);
       }
-    }
-    for (size_t i = 0; i < actions_.size(); ++i) {
-      auto it = std::partition(actions_[i].begin(), actions_[i].end(),
-                               [this](const auto &a) { return is_valid(a); });
-      if (it != actions_[i].end()) {
-        std::for_each(it, actions_[i].end(), [&](const auto &a) {
-          num_pruned_actions_ += get_num_instantiated(a, *problem_);
-        });
-        actions_[i].erase(it, actions_[i].end());
-        changed = true;
+    };
+    for (size_t i = 0; i < conditions.preconditions.size(); ++i) {
+      if (!action.removed[i]) {
+        const auto &precondition = conditions.preconditions[i];
+        add(condition_index_[precondition.atom.predicate]
+                .preconditions[schema],
+            precondition.atom);
       }
-      for (auto &a : actions_[i]) {
-        if (simplify(a)) {
-          changed = true;
-        }
+    }
+    for (size_t i = 0; i < conditions.effects.size(); ++i) {
+      if (!action.removed[offset + i]) {
+        const auto &effect = conditions.effects[i];
+        auto &index = condition_index_[effect.atom.predicate];
+        add(effect.positive ? index.pos_effects[schema]
+                            : index.neg_effects[schema],
+            effect.atom);
       }
     }
-  } while (changed);
+  }
+  for (auto &index : condition_index_) {
+    for (auto *positions : {&index.preconditions[schema],
+                            &index.pos_effects[schema],
+                            &index.neg_effects[schema]}) {
+      std::sort(positions->ground.begin(), positions->ground.end());
+    }
+  }
 }
 
-bool Grounder::is_valid(const Action &action) const noexcept {
-  if (action.ground_effects.empty() && action.effects.empty()) {
-    return false;
+bool Grounder::is_relaxed_applicable(size_t schema,
+                                     const PartialAction &action) const
+    noexcept {
+  const auto &preconditions = schemas_[schema].preconditions;
+  for (size_t i = 0; i < preconditions.size(); ++i) {
+    if (action.removed[i] || !preconditions[i].positive) {
+      continue;
+    }
+    const auto &reachable = reachable_[preconditions[i].atom.predicate];
+    if (!any_instance(preconditions[i].atom, action, [&](const auto &atom) {
+          return reachable.get(get_id(atom)) == AtomCache::Result::True;
+        })) {
+      return false;
+    }
   }
-  if (std::any_of(action.ground_preconditions.begin(),
-                  action.ground_preconditions.end(), [this](const auto &p) {
-                    return is_rigid(p.first, !p.second);
-                  })) {
-    return false;
+  return true;
+}
+
+void Grounder::update_reachability() noexcept {
+  if (config.pruning_policy == Config::PruningPolicy::Trivial) {
+    return;
   }
-  if (config.pruning_policy == Config::PruningPolicy::Eager &&
-      std::any_of(action.preconditions.begin(), action.preconditions.end(),
-                  [&](const auto &precondition) {
-                    for (auto it = GroundAtomIterator{precondition.atom, action,
-                                                      *problem_};
-                         it != GroundAtomIterator{}; ++it) {
-                      if (!is_rigid(*it, !precondition.positive)) {
-                        return false;
-                      }
-                    }
-                    return true;
-                  })) {
-    return false;
+
+  reachable_.clear();
+  reachable_.reserve(problem_->predicates.size());
+  for (const auto &predicate : problem_->predicates) {
+    reachable_.emplace_back(get_num_atom_ids(predicate.parameter_types.size(),
+                                             problem_->constants.size()));
+  }
+  for (const auto &atom : problem_->init) {
+    reachable_[atom.predicate].set(get_id(atom), true);
   }
 
-  if (action.effects.empty() &&
-      std::all_of(action.ground_effects.begin(), action.ground_effects.end(),
-                  [this](const auto &e) {
-                    return is_rigid(e.first, e.second) || is_useless(e.first);
-                  })) {
-    return false;
+  // Relaxed planning graph over the partially grounded actions. An action is
+  // only revisited when an atom of one of its precondition predicates becomes
+  // reachable.
+  std::vector<std::pair<size_t, uint_fast64_t>> worklist;
+  std::vector<std::vector<char>> queued(actions_.size());
+  std::vector<std::vector<char>> applied(actions_.size());
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    queued[i].resize(actions_[i].size(), true);
+    applied[i].resize(actions_[i].size(), false);
+    for (uint_fast64_t j = 0; j < actions_[i].size(); ++j) {
+      worklist.emplace_back(i, j);
+    }
+  }
+  std::vector<char> new_atoms(problem_->predicates.size(), false);
+
+  auto add = [&](const GroundAtom &atom) {
+    auto &reachable = reachable_[atom.predicate];
+    auto id = get_id(atom);
+    if (reachable.get(id) != AtomCache::Result::True) {
+      reachable.set(id, true);
+      new_atoms[atom.predicate] = true;
+    }
+  };
+
+  while (!worklist.empty()) {
+    while (!worklist.empty()) {
+      auto [i, j] = worklist.back();
+      worklist.pop_back();
+      queued[i][j] = false;
+      const auto &action = actions_[i][j];
+      if (!is_relaxed_applicable(i, action)) {
+        continue;
+      }
+      applied[i][j] = true;
+      const auto &effects = schemas_[i].effects;
+      auto offset = schemas_[i].preconditions.size();
+      for (size_t k = 0; k < effects.size(); ++k) {
+        if (!action.removed[offset + k] && effects[k].positive) {
+          any_instance(effects[k].atom, action, [&](const auto &atom) {
+            add(atom);
+            return false;
+          });
+        }
+      }
+    }
+    for (size_t p = 0; p < new_atoms.size(); ++p) {
+      if (!new_atoms[p]) {
+        continue;
+      }
+      const auto &index = condition_index_[p].preconditions;
+      for (size_t i = 0; i < index.size(); ++i) {
+        index[i].for_each([&](auto j) {
+          if (!applied[i][j] && !queued[i][j]) {
+            queued[i][j] = true;
+            worklist.emplace_back(i, j);
+          }
+        });
+      }
+      new_atoms[p] = false;
+    }
   }
-  return true;
 }
 
-std::pair<normalized::Action, bool>
-Grounder::ground(const normalized::Action &action,
-                 const normalized::ParameterAssignment &assignment) const
+bool Grounder::is_relevant(size_t schema, const PartialAction &action) const
     noexcept {
-  Action new_action{};
-  new_action.id = action.id;
-  new_action.parameters = action.parameters;
+  const auto &effects = schemas_[schema].effects;
+  auto offset = schemas_[schema].preconditions.size();
+  for (size_t i = 0; i < effects.size(); ++i) {
+    if (!action.removed[offset + i] && is_relevant(effects[i].atom, action)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  for (auto [p, c] : assignment) {
-    new_action.parameters[p].set(c);
+bool Grounder::is_relevant(const Atom &atom,
+                           const PartialAction &action) const noexcept {
+  const auto &relevant = relevant_[atom.predicate];
+  return any_instance(atom, action, [&](const auto &ground_atom) {
+    return relevant.get(get_id(ground_atom)) == AtomCache::Result::True;
+  });
+}
+
+void Grounder::update_relevance() noexcept {
+  if (config.pruning_policy == Config::PruningPolicy::Trivial) {
+    return;
   }
-  for (const auto &[precondition, positive] : action.ground_preconditions) {
-    if (is_rigid(precondition, !positive)) {
-      return {new_action, false};
-    } else if (!is_rigid(precondition, positive)) {
-      new_action.ground_preconditions.emplace_back(precondition, positive);
+
+  relevant_.clear();
+  relevant_.reserve(problem_->predicates.size());
+  for (const auto &predicate : problem_->predicates) {
+    relevant_.emplace_back(get_num_atom_ids(predicate.parameter_types.size(),
+                                            problem_->constants.size()));
+  }
+  for (const auto &[atom, positive] : problem_->goal) {
+    relevant_[atom.predicate].set(get_id(atom), true);
+  }
+
+  // Backward from the goal, an action is only revisited when an atom of one
+  // of its effect predicates becomes relevant
+  std::vector<std::pair<size_t, uint_fast64_t>> worklist;
+  std::vector<std::vector<char>> queued(actions_.size());
+  std::vector<std::vector<char>> applied(actions_.size());
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    queued[i].resize(actions_[i].size(), true);
+    applied[i].resize(actions_[i].size(), false);
+    for (uint_fast64_t j = 0; j < actions_[i].size(); ++j) {
+      worklist.emplace_back(i, j);
     }
   }
-  for (auto precondition : action.preconditions) {
-    if (update_condition(precondition, new_action)) {
-      auto new_precondition = as_ground_atom(precondition.atom);
-      if (is_rigid(new_precondition, !precondition.positive)) {
-        return {new_action, false};
-      } else if (!is_rigid(new_precondition, precondition.positive)) {
-        new_action.ground_preconditions.emplace_back(new_precondition,
-                                                     precondition.positive);
-      }
-    } else {
-      if (config.pruning_policy == Config::PruningPolicy::Eager) {
-        bool unsatisfiable = true;
-        for (auto it = GroundAtomIterator{precondition.atom, action, *problem_};
-             it != GroundAtomIterator{}; ++it) {
-          if (!is_rigid(*it, !precondition.positive)) {
-            unsatisfiable = false;
-            break;
-          }
+  std::vector<char> new_atoms(problem_->predicates.size(), false);
+
+  auto add = [&](const GroundAtom &atom) {
+    auto &relevant = relevant_[atom.predicate];
+    auto id = get_id(atom);
+    if (relevant.get(id) != AtomCache::Result::True) {
+      relevant.set(id, true);
+      new_atoms[atom.predicate] = true;
+    }
+  };
+
+  auto enqueue = [&](const std::vector<Positions> &index) {
+    for (size_t i = 0; i < index.size(); ++i) {
+      index[i].for_each([&](auto j) {
+        if (!applied[i][j] && !queued[i][j]) {
+          queued[i][j] = true;
+          worklist.emplace_back(i, j);
         }
-        if (unsatisfiable) {
-          return {new_action, false};
+      });
+    }
+  };
+
+  while (!worklist.empty()) {
+    while (!worklist.empty()) {
+      auto [i, j] = worklist.back();
+      worklist.pop_back();
+      queued[i][j] = false;
+      const auto &action = actions_[i][j];
+      if (!is_relevant(i, action)) {
+        continue;
+      }
+      applied[i][j] = true;
+      const auto &preconditions = schemas_[i].preconditions;
+      for (size_t k = 0; k < preconditions.size(); ++k) {
+        if (!action.removed[k]) {
+          any_instance(preconditions[k].atom, action, [&](const auto &atom) {
+            add(atom);
+            return false;
+          });
         }
-        new_action.preconditions.push_back(std::move(precondition));
-      } else {
-        new_action.preconditions.push_back(std::move(precondition));
       }
     }
+    for (size_t p = 0; p < new_atoms.size(); ++p) {
+      if (!new_atoms[p]) {
+        continue;
+      }
+      enqueue(condition_index_[p].pos_effects);
+      enqueue(condition_index_[p].neg_effects);
+      new_atoms[p] = false;
+    }
   }
-  for (const auto &[effect, positive] : action.ground_effects) {
-    if (!is_rigid(effect, positive) && !is_useless(effect)) {
-      new_action.ground_effects.emplace_back(effect, positive);
+}
+
+void Grounder::prune() noexcept {
+  // Reachability and relevance are computed over all current actions,
+  // including those that are only pruned afterwards because they are
+  // unreachable. Their conditions can keep atoms relevant or reachable, so
+  // the analyses are repeated until no more actions or conditions are removed.
+  do {
+    update_reachability();
+    update_relevance();
+  } while (prune_actions() &&
+           config.pruning_policy != Config::PruningPolicy::Trivial);
+}
+
+bool Grounder::prune_actions() noexcept {
+  // Actions may have been replaced since the last call
+  if (config.cache_policy == Config::CachePolicy::Unsuccessful) {
+    for (auto &c : cache_) {
+      c.pos_rigid.clear_false();
+      c.neg_rigid.clear_false();
+      c.useless.clear_false();
+    }
+  }
+
+  // The rigidity and uselessness of an atom only depend on the conditions on
+  // its predicate. Thus, removing a condition only requires revisiting the
+  // actions with a condition on the same predicate that reads the changed
+  // property. Pruned actions have all conditions removed in place so that the
+  // positions in the condition index remain valid until the schemas are
+  // compacted.
+  std::vector<std::pair<size_t, uint_fast64_t>> worklist;
+  std::vector<std::vector<char>> queued(actions_.size());
+  std::vector<std::vector<char>> pruned(actions_.size());
+  std::vector<char> changed(actions_.size(), false);
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    queued[i].resize(actions_[i].size(), true);
+    pruned[i].resize(actions_[i].size(), false);
+    for (uint_fast64_t j = 0; j < actions_[i].size(); ++j) {
+      worklist.emplace_back(i, j);
     }
   }
-  for (auto effect : action.effects) {
-    if (update_condition(effect, new_action)) {
-      auto new_effect = as_ground_atom(effect.atom);
-      if (!is_rigid(new_effect, effect.positive) && !is_useless(new_effect)) {
-        new_action.ground_effects.emplace_back(new_effect, effect.positive);
+  std::vector<uint_fast8_t> removed(problem_->predicates.size(), 0);
+
+  auto enqueue = [&](const std::vector<Positions> &index) {
+    for (size_t i = 0; i < index.size(); ++i) {
+      index[i].for_each([&](auto j) {
+        if (!pruned[i][j] && !queued[i][j]) {
+          queued[i][j] = true;
+          worklist.emplace_back(i, j);
+        }
+      });
+    }
+  };
+
+  while (!worklist.empty()) {
+    while (!worklist.empty()) {
+      auto [i, j] = worklist.back();
+      worklist.pop_back();
+      queued[i][j] = false;
+      auto &action = actions_[i][j];
+      const auto &conditions = schemas_[i];
+      auto offset = conditions.preconditions.size();
+      if (is_valid(i, action)) {
+        if (simplify(i, action, removed)) {
+          changed[i] = true;
+        }
+        if (std::find(action.removed.begin() +
+                          static_cast<std::ptrdiff_t>(offset),
+                      action.removed.end(),
+                      false) != action.removed.end()) {
+          continue;
+        }
       }
-    } else {
-      if (config.pruning_policy == Config::PruningPolicy::Eager) {
-        bool keep_effect = false;
-        for (auto it = GroundAtomIterator{effect.atom, action, *problem_};
-             it != GroundAtomIterator{}; ++it) {
-          if (!is_rigid(*it, effect.positive) && !is_useless(*it)) {
-            keep_effect = true;
-            break;
-          }
+      num_pruned_actions_ +=
+          get_num_instantiated(action.parameters, *problem_);
+      for (size_t k = 0; k < conditions.preconditions.size(); ++k) {
+        if (!action.removed[k]) {
+          removed[conditions.preconditions[k].atom.predicate] |= Precondition;
         }
-        if (keep_effect) {
-          new_action.effects.push_back(std::move(effect));
+      }
+      for (size_t k = 0; k < conditions.effects.size(); ++k) {
+        if (!action.removed[offset + k]) {
+          const auto &effect = conditions.effects[k];
+          removed[effect.atom.predicate] |=
+              effect.positive ? PosEffect : NegEffect;
         }
-      } else {
-        new_action.effects.push_back(std::move(effect));
       }
+      std::fill(action.removed.begin(), action.removed.end(), true);
+      pruned[i][j] = true;
+      changed[i] = true;
+    }
+
+    // Outdated unsuccessful results read while processing the worklist only
+    // kept actions, which are revisited here
+    for (size_t p = 0; p < removed.size(); ++p) {
+      if (removed[p] == 0) {
+        continue;
+      }
+      const auto &index = condition_index_[p];
+      bool cache_fail =
+          config.cache_policy == Config::CachePolicy::Unsuccessful;
+      if (removed[p] & Precondition) {
+        if (cache_fail) {
+          cache_[p].useless.clear_false();
+        }
+        enqueue(index.pos_effects);
+        enqueue(index.neg_effects);
+      }
+      if (removed[p] & PosEffect) {
+        if (cache_fail) {
+          cache_[p].neg_rigid.clear_false();
+        }
+        enqueue(index.preconditions);
+        enqueue(index.neg_effects);
+      }
+      if (removed[p] & NegEffect) {
+        if (cache_fail) {
+          cache_[p].pos_rigid.clear_false();
+        }
+        enqueue(index.preconditions);
+        enqueue(index.pos_effects);
+      }
+      removed[p] = 0;
+    }
+  }
+
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    if (!changed[i]) {
+      continue;
+    }
+    size_t num_valid = 0;
+    for (size_t j = 0; j < actions_[i].size(); ++j) {
+      if (!pruned[i][j]) {
+        if (num_valid != j) {
+          actions_[i][num_valid] = std::move(actions_[i][j]);
+        }
+        ++num_valid;
+      }
+    }
+    actions_[i].erase(actions_[i].begin() +
+                          static_cast<std::ptrdiff_t>(num_valid),
+                      actions_[i].end());
+    update_condition_index(i);
+  }
+  return std::find(changed.begin(), changed.end(), true) != changed.end();
+}
+
+// Fully grounds all schemas at once, starting from the reachable ground actions
+// instead of the partially grounded ones. The datalog fixpoint only drops
+// actions that are unreachable in the delete relaxation, which prune removes
+// from the result of refine as well. As prune repeats the analyses until no
+// more actions are removed, both yield the same actions up to their order.
+void Grounder::ground_reachable(util::Seconds timeout) {
+  LOG_INFO(grounder_logger, "Grounding reachable actions...");
+  auto reachable = DatalogGrounder{*problem_}.ground(timeout);
+  if (!reachable) {
+    return;
+  }
+  // The current actions are kept until all schemas are grounded, as they are
+  // cheaper to check rigidity and uselessness against
+  std::vector<std::vector<PartialAction>> ground_actions(actions_.size());
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    const auto &conditions = schemas_[i];
+    PartialAction schema{
+        problem_->actions[i].parameters,
+        std::vector<bool>(
+            conditions.preconditions.size() + conditions.effects.size(),
+            false)};
+    std::vector<PartialAction> new_actions;
+    ParameterAssignment assignment;
+    for (const auto &arguments : (*reachable)[i]) {
+      assignment.clear();
+      for (size_t p = 0; p < arguments.size(); ++p) {
+        if (schema.parameters[p].is_free()) {
+          assignment.emplace_back(ParameterIndex{p}, arguments[p]);
+        }
+      }
+      auto [new_action, valid] = ground(i, schema, assignment);
+      if (valid) {
+        new_actions.push_back(std::move(new_action));
+      }
+    }
+    ground_actions[i] = std::move(new_actions);
+  }
+  actions_ = std::move(ground_actions);
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    action_grounded_[i] = true;
+    update_condition_index(i);
+  }
+  prune();
+  num_pruned_actions_ = num_actions_ - get_num_actions();
+  groundness_ = 1.0f;
+}
+
+bool Grounder::is_valid(size_t schema, const PartialAction &action) const
+    noexcept {
+  const auto &conditions = schemas_[schema];
+  auto offset = conditions.preconditions.size();
+  for (size_t i = 0; i < conditions.preconditions.size(); ++i) {
+    if (action.removed[i]) {
+      continue;
+    }
+    const auto &precondition = conditions.preconditions[i];
+    if (is_assigned(precondition.atom, action)) {
+      if (is_rigid(get_ground_atom(precondition.atom, action),
+                   !precondition.positive)) {
+        return false;
+      }
+    } else if (config.pruning_policy == Config::PruningPolicy::Eager &&
+               !any_instance(precondition.atom, action,
+                             [&](const auto &atom) {
+                               return !is_rigid(atom, !precondition.positive);
+                             })) {
+      return false;
     }
   }
 
-  if (new_action.ground_effects.empty() && new_action.effects.empty()) {
-    return {new_action, false};
+  // Valid if any effect is lifted or neither rigid nor useless
+  for (size_t i = 0; i < conditions.effects.size(); ++i) {
+    if (action.removed[offset + i]) {
+      continue;
+    }
+    const auto &effect = conditions.effects[i];
+    if (!is_assigned(effect.atom, action)) {
+      return true;
+    }
+    auto ground_effect = get_ground_atom(effect.atom, action);
+    if (!is_rigid(ground_effect, effect.positive) &&
+        !is_useless(ground_effect)) {
+      return true;
+    }
   }
-  return {new_action, true};
+  return false;
 }
 
-bool Grounder::simplify(Action &action) const noexcept {
+std::pair<Grounder::PartialAction, bool>
+Grounder::ground(size_t schema, const PartialAction &action,
+                 const ParameterAssignment &assignment) const noexcept {
+  PartialAction new_action{action.parameters, action.removed};
+
+  for (auto [p, c] : assignment) {
+    new_action.parameters[p].set(c);
+  }
+
+  const auto &conditions = schemas_[schema];
+  auto offset = conditions.preconditions.size();
+  for (size_t i = 0; i < conditions.preconditions.size(); ++i) {
+    if (new_action.removed[i]) {
+      continue;
+    }
+    const auto &precondition = conditions.preconditions[i];
+    if (is_assigned(precondition.atom, new_action)) {
+      auto new_precondition = get_ground_atom(precondition.atom, new_action);
+      if (is_rigid(new_precondition, !precondition.positive)) {
+        return {new_action, false};
+      } else if (is_rigid(new_precondition, precondition.positive)) {
+        new_action.removed[i] = true;
+      }
+    } else if (config.pruning_policy == Config::PruningPolicy::Eager &&
+               !any_instance(precondition.atom, new_action,
+                             [&](const auto &atom) {
+                               return !is_rigid(atom, !precondition.positive);
+                             })) {
+      return {new_action, false};
+    }
+  }
+  bool has_effect = false;
+  for (size_t i = 0; i < conditions.effects.size(); ++i) {
+    if (new_action.removed[offset + i]) {
+      continue;
+    }
+    const auto &effect = conditions.effects[i];
+    auto keep_effect = [&](const auto &atom) {
+      return !is_rigid(atom, effect.positive) && !is_useless(atom);
+    };
+    if (is_assigned(effect.atom, new_action)) {
+      if (!keep_effect(get_ground_atom(effect.atom, new_action))) {
+        new_action.removed[offset + i] = true;
+        continue;
+      }
+    } else if (config.pruning_policy == Config::PruningPolicy::Eager &&
+               !any_instance(effect.atom, new_action, keep_effect)) {
+      new_action.removed[offset + i] = true;
+      continue;
+    }
+    has_effect = true;
+  }
+
+  return {new_action, has_effect};
+}
+
+bool Grounder::simplify(size_t schema, PartialAction &action,
+                        std::vector<uint_fast8_t> &removed) const noexcept {
+  const auto &conditions = schemas_[schema];
+  auto offset = conditions.preconditions.size();
   bool changed = false;
-  if (auto it = std::remove_if(
-          action.ground_effects.begin(), action.ground_effects.end(),
-          [this](const auto &e) {
-            return is_rigid(e.first, e.second) || is_useless(e.first);
-          });
-      it != action.ground_effects.end()) {
-    action.ground_effects.erase(it, action.ground_effects.end());
+  for (size_t i = 0; i < conditions.effects.size(); ++i) {
+    const auto &effect = conditions.effects[i];
+    if (action.removed[offset + i]) {
+      continue;
+    }
+    if (is_assigned(effect.atom, action)) {
+      auto ground_effect = get_ground_atom(effect.atom, action);
+      if (!is_rigid(ground_effect, effect.positive) &&
+          !is_useless(ground_effect)) {
+        continue;
+      }
+    } else if (config.pruning_policy == Config::PruningPolicy::Trivial ||
+               is_relevant(effect.atom, action)) {
+      continue;
+    }
+    removed[effect.atom.predicate] |= effect.positive ? PosEffect : NegEffect;
+    action.removed[offset + i] = true;
     changed = true;
   }
 
-  if (auto it = std::remove_if(
-          action.ground_preconditions.begin(),
-          action.ground_preconditions.end(),
-          [this](const auto &p) { return is_rigid(p.first, p.second); });
-      it != action.ground_preconditions.end()) {
-    action.ground_preconditions.erase(it, action.ground_preconditions.end());
-    changed = true;
+  for (size_t i = 0; i < conditions.preconditions.size(); ++i) {
+    const auto &precondition = conditions.preconditions[i];
+    if (!action.removed[i] && is_assigned(precondition.atom, action) &&
+        is_rigid(get_ground_atom(precondition.atom, action),
+                 precondition.positive)) {
+      removed[precondition.atom.predicate] |= Precondition;
+      action.removed[i] = true;
+      changed = true;
+    }
   }
   return changed;
 }
@@ -576,10 +1293,22 @@ std::shared_ptr<Problem> Grounder::extract_problem() const noexcept {
   std::copy_if(problem_->goal.begin(), problem_->goal.end(),
                std::back_inserter(preprocessed_problem->goal),
                [this](const auto &g) { return !is_rigid(g.first, g.second); });
-  for (size_t i = 0; i < problem_->actions.size(); ++i) {
-    for (auto &action : actions_[i]) {
-      preprocessed_problem->actions.push_back(std::move(action));
+  // Schemas that did not change since an extracted problem that is still
+  // alive share their actions with it instead of materializing them again
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    auto actions = materialized_[i].lock();
+    if (!actions) {
+      std::vector<Action> new_actions;
+      new_actions.reserve(actions_[i].size());
+      for (const auto &action : actions_[i]) {
+        new_actions.push_back(materialize(i, action));
+      }
+      actions = std::make_shared<const std::vector<Action>>(
+          std::move(new_actions));
+      materialized_[i] = actions;
     }
+    preprocessed_problem->actions.append(
+        util::SharedVector<Action>{std::move(actions)});
   }
   preprocessed_problem->action_names = problem_->action_names;
 
@@ -2,6 +2,7 @@
 #define GROUNDER_HPP
 
 #include "config.hpp"
+#include "grounder/atom_cache.hpp"
 #include "logging/logging.hpp"
 #include "model/normalized/model.hpp"
 #include "model/normalized/utils.hpp"
@@ -11,7 +12,7 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <unordered_set>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -30,17 +31,68 @@ public:
   void refine(float groundness, util::Seconds timeout);
   size_t get_num_actions() const noexcept;
   float get_groundness() const noexcept;
+  bool is_unsolvable() const noexcept;
   std::shared_ptr<normalized::Problem> extract_problem() const noexcept;
 
 private:
+  // Conditions of an action schema, with the ground conditions of the schema
+  // represented as atoms with constant arguments
+  struct Schema {
+    std::vector<normalized::Condition> preconditions;
+    std::vector<normalized::Condition> effects;
+  };
+
+  // Partially grounded action as an assignment to the parameters of its
+  // schema. Conditions of the schema that were pruned as rigid or useless are
+  // marked as removed, first the preconditions and then the effects. The
+  // conditions themselves are only materialized in extract_problem.
+  struct PartialAction {
+    std::vector<normalized::Parameter> parameters;
+    std::vector<bool> removed;
+  };
+
   PredicateId get_id(const normalized::GroundAtom &predicate) const noexcept;
+  PredicateId get_id(const normalized::Atom &atom,
+                     const PartialAction &action) const noexcept;
   bool is_trivially_rigid(const normalized::GroundAtom &predicate,
                           bool positive) const noexcept;
   bool is_trivially_useless(const normalized::GroundAtom &predicate) const
       noexcept;
-  bool has_precondition(const normalized::Action &action,
+  bool is_assigned(const normalized::Atom &atom,
+                   const PartialAction &action) const noexcept;
+  normalized::GroundAtom get_ground_atom(const normalized::Atom &atom,
+                                         const PartialAction &action) const
+      noexcept;
+  bool is_instance(const normalized::Atom &atom, const PartialAction &action,
+                   const normalized::GroundAtom &ground_atom) const noexcept;
+
+  // Calls f for each instance of the atom under the assignment of the action
+  // until f returns true, and returns whether it did
+  template <typename F>
+  bool any_instance(const normalized::Atom &atom, const PartialAction &action,
+                    F &&f) const noexcept {
+    if (is_assigned(atom, action)) {
+      return f(get_ground_atom(atom, action));
+    }
+    normalized::Action partial_action;
+    partial_action.parameters = action.parameters;
+    auto condition = normalized::Condition{atom, true};
+    normalized::update_condition(condition, partial_action);
+    for (auto it = normalized::GroundAtomIterator{condition.atom,
+                                                  partial_action, *problem_};
+         it != normalized::GroundAtomIterator{}; ++it) {
+      if (f(*it)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  normalized::Action materialize(size_t schema,
+                                 const PartialAction &action) const noexcept;
+  bool has_precondition(size_t schema, const PartialAction &action,
                         const normalized::GroundAtom &predicate) const noexcept;
-  bool has_effect(const normalized::Action &action,
+  bool has_effect(size_t schema, const PartialAction &action,
                   const normalized::GroundAtom &predicate, bool positive) const
       noexcept;
 
@@ -48,59 +100,63 @@ private:
   template <bool cache_success, bool cache_fail>
   bool is_rigid(const normalized::GroundAtom &atom, bool positive) const
       noexcept {
-    auto &rigid = (positive ? successful_cache_[atom.predicate].pos_rigid
-                            : successful_cache_[atom.predicate].neg_rigid);
-    auto &not_rigid =
-        (positive ? unsuccessful_cache_[atom.predicate].pos_rigid
-                  : unsuccessful_cache_[atom.predicate].neg_rigid);
+    auto &rigid = (positive ? cache_[atom.predicate].pos_rigid
+                            : cache_[atom.predicate].neg_rigid);
     auto id = get_id(atom);
 
-    if (cache_success && (rigid.find(id) != rigid.end())) {
-      return true;
-    }
-
-    if (cache_fail && (not_rigid.find(id) != not_rigid.end())) {
-      return false;
+    if (cache_success || cache_fail) {
+      auto cached = rigid.get(id);
+      if (cache_success && cached == AtomCache::Result::True) {
+        return true;
+      }
+      if (cache_fail && cached == AtomCache::Result::False) {
+        return false;
+      }
     }
 
-    if (std::binary_search(init_[atom.predicate].begin(),
-                           init_[atom.predicate].end(), id) != positive) {
+    if (init_[atom.predicate].contains(id) != positive) {
       if (cache_fail) {
-        not_rigid.insert(id);
+        rigid.set(id, false);
       }
       return false;
     }
 
     if (trivially_rigid_[atom.predicate]) {
       if (cache_success) {
-        rigid.insert(id);
+        rigid.set(id, true);
       }
       return true;
     }
 
     if (config.pruning_policy == Config::PruningPolicy::Trivial) {
       if (cache_fail) {
-        not_rigid.insert(id);
+        rigid.set(id, false);
       }
       return false;
     }
 
-    for (size_t i = 0; i < problem_->actions.size(); ++i) {
-      const auto &base_action = problem_->actions[i];
-      if (!has_effect(base_action, atom, !positive)) {
-        continue;
+    if (!positive &&
+        reachable_[atom.predicate].get(id) != AtomCache::Result::True) {
+      if (cache_success) {
+        rigid.set(id, true);
       }
-      for (const auto &action : actions_[i]) {
-        if (has_effect(action, atom, !positive)) {
-          if (cache_fail) {
-            not_rigid.insert(id);
-          }
-          return false;
+      return true;
+    }
+
+    const auto &index = positive ? condition_index_[atom.predicate].neg_effects
+                                 : condition_index_[atom.predicate].pos_effects;
+    for (size_t i = 0; i < index.size(); ++i) {
+      if (index[i].any_of(id, [&](auto j) {
+            return has_effect(i, actions_[i][j], atom, !positive);
+          })) {
+        if (cache_fail) {
+          rigid.set(id, false);
         }
+        return false;
       }
     }
     if (cache_success) {
-      rigid.insert(id);
+      rigid.set(id, true);
     }
     return true;
   }
@@ -111,62 +167,72 @@ private:
   // No action has this predicate as precondition and it is a not a goal
   template <bool cache_success, bool cache_fail>
   bool is_useless(const normalized::GroundAtom &atom) const noexcept {
-    auto &useless = successful_cache_[atom.predicate].useless;
-    auto &not_useless = unsuccessful_cache_[atom.predicate].useless;
+    auto &useless = cache_[atom.predicate].useless;
     auto id = get_id(atom);
 
-    if (cache_success && (useless.find(id) != useless.end())) {
-      return true;
-    }
-
-    if (cache_fail && (not_useless.find(id) != not_useless.end())) {
-      return false;
+    if (cache_success || cache_fail) {
+      auto cached = useless.get(id);
+      if (cache_success && cached == AtomCache::Result::True) {
+        return true;
+      }
+      if (cache_fail && cached == AtomCache::Result::False) {
+        return false;
+      }
     }
 
-    if (std::binary_search(goal_[atom.predicate].begin(),
-                           goal_[atom.predicate].end(), id)) {
+    if (goal_[atom.predicate].contains(id)) {
       if (cache_fail) {
-        not_useless.insert(id);
+        useless.set(id, false);
       }
       return false;
     }
 
     if (trivially_useless_[atom.predicate]) {
       if (cache_success) {
-        useless.insert(id);
+        useless.set(id, true);
       }
       return true;
     }
 
     if (config.pruning_policy == Config::PruningPolicy::Trivial) {
       if (cache_fail) {
-        not_useless.insert(id);
+        useless.set(id, false);
       }
       return false;
     }
 
-    for (size_t i = 0; i < problem_->actions.size(); ++i) {
-      const auto &action = problem_->actions[i];
-      if (has_precondition(action, atom)) {
-        for (const auto &action : actions_[i]) {
-          if (has_precondition(action, atom)) {
-            if (cache_fail) {
-              not_useless.insert(id);
-            }
-            return false;
-          }
+    if (relevant_[atom.predicate].get(id) != AtomCache::Result::True) {
+      if (cache_success) {
+        useless.set(id, true);
+      }
+      return true;
+    }
+
+    const auto &index = condition_index_[atom.predicate].preconditions;
+    for (size_t i = 0; i < index.size(); ++i) {
+      if (index[i].any_of(id, [&](auto j) {
+            return has_precondition(i, actions_[i][j], atom);
+          })) {
+        if (cache_fail) {
+          useless.set(id, false);
         }
+        return false;
       }
     }
 
     if (cache_success) {
-      useless.insert(id);
+      useless.set(id, true);
     }
     return true;
   }
 
   bool is_useless(const normalized::GroundAtom &atom) const noexcept;
 
+  normalized::AssignmentConstraints
+  get_constraints(size_t schema, const PartialAction &action,
+                  const normalized::ParameterSelection &selection) const
+      noexcept;
+
   normalized::ParameterSelection
   select_most_frequent(const normalized::Action &action) const noexcept;
   normalized::ParameterSelection
@@ -180,31 +246,120 @@ private:
   normalized::ParameterSelection
   select_first_effect(const normalized::Action &action) const noexcept;
 
-  void prune_actions() noexcept;
-  bool is_valid(const normalized::Action &action) const noexcept;
-  std::pair<normalized::Action, bool>
-  ground(const normalized::Action &action,
+  // Kinds of conditions on a predicate, used as bit flags to record which
+  // conditions were removed while pruning
+  enum ConditionKind : uint_fast8_t {
+    Precondition = 1,
+    PosEffect = 2,
+    NegEffect = 4
+  };
+
+  // Has to be called whenever the actions of the schema change
+  void update_condition_index(size_t schema) noexcept;
+  bool is_relaxed_applicable(size_t schema, const PartialAction &action) const
+      noexcept;
+  void update_reachability() noexcept;
+  bool is_relevant(size_t schema, const PartialAction &action) const noexcept;
+  bool is_relevant(const normalized::Atom &atom,
+                   const PartialAction &action) const noexcept;
+  void update_relevance() noexcept;
+  void prune() noexcept;
+  // Returns whether any action or condition was removed
+  bool prune_actions() noexcept;
+  void ground_reachable(util::Seconds timeout);
+  bool is_valid(size_t schema, const PartialAction &action) const noexcept;
+  std::pair<PartialAction, bool>
+  ground(size_t schema, const PartialAction &action,
          const normalized::ParameterAssignment &assignment) const noexcept;
-  bool simplify(normalized::Action &action) const noexcept;
+  bool simplify(size_t schema, PartialAction &action,
+                std::vector<uint_fast8_t> &removed) const noexcept;
 
   float groundness_;
   uint_fast64_t num_actions_;
   uint_fast64_t num_pruned_actions_ = 0;
-  std::vector<std::vector<normalized::Action>> actions_;
+  std::vector<Schema> schemas_;
+  std::vector<std::vector<PartialAction>> actions_;
   std::vector<bool> trivially_rigid_;
   std::vector<bool> trivially_useless_;
-  std::vector<std::vector<PredicateId>> init_;
-  std::vector<std::vector<PredicateId>> goal_;
+  std::vector<AtomSet> init_;
+  std::vector<AtomSet> goal_;
+  // Init atoms of the trivially rigid predicates, which constrain the
+  // assignments enumerated in refine
+  std::vector<std::vector<normalized::GroundAtom>> rigid_init_;
   std::vector<bool> action_grounded_;
 
+  // Successful and unsuccessful results of is_rigid and is_useless
   struct Cache {
-    std::unordered_set<PredicateId> pos_rigid;
-    std::unordered_set<PredicateId> neg_rigid;
-    std::unordered_set<PredicateId> useless;
+    AtomCache pos_rigid;
+    AtomCache neg_rigid;
+    AtomCache useless;
+  };
+
+  mutable std::vector<Cache> cache_;
+
+  // Positions in actions_[i] of the actions of schema i with a condition on
+  // a predicate. Ground conditions are kept with the id of their atom, so that
+  // the actions with a ground condition on an atom can be looked up.
+  struct Positions {
+    std::vector<uint_fast64_t> lifted;
+    // Sorted by id
+    std::vector<std::pair<uint_fast64_t, uint_fast64_t>> ground;
+
+    // Calls f for the positions of the actions that may have a condition on
+    // the atom with the given id until f returns true, and returns whether it
+    // did
+    template <typename F> bool any_of(uint_fast64_t id, F &&f) const noexcept {
+      for (auto j : lifted) {
+        if (f(j)) {
+          return true;
+        }
+      }
+      auto it = std::lower_bound(
+          ground.begin(), ground.end(), id,
+          [](const auto &entry, uint_fast64_t value) {
+            return entry.first < value;
+          });
+      for (; it != ground.end() && it->first == id; ++it) {
+        if (f(it->second)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    template <typename F> void for_each(F &&f) const noexcept {
+      for (auto j : lifted) {
+        f(j);
+      }
+      for (const auto &entry : ground) {
+        f(entry.second);
+      }
+    }
+  };
+
+  // Positions of the actions with a precondition or an effect of the given
+  // polarity on a predicate, indexed by predicate and schema. Only the listed
+  // actions can make an atom of the predicate non-rigid or useful.
+  struct ConditionIndex {
+    std::vector<Positions> preconditions;
+    std::vector<Positions> pos_effects;
+    std::vector<Positions> neg_effects;
   };
 
-  mutable std::vector<Cache> successful_cache_;
-  mutable std::vector<Cache> unsuccessful_cache_;
+  std::vector<ConditionIndex> condition_index_;
+
+  // Materialized actions of each schema while an extracted problem still
+  // uses them. Reset when the actions of the schema change.
+  mutable std::vector<std::weak_ptr<const std::vector<normalized::Action>>>
+      materialized_;
+
+  // Atoms reachable from init_ when ignoring negative preconditions and
+  // delete effects, marked as True. Unreachable atoms are rigidly false.
+  std::vector<AtomCache> reachable_;
+
+  // Atoms that the goal depends on through the preconditions of actions with
+  // relevant effects, marked as True. Irrelevant atoms are useless.
+  std::vector<AtomCache> relevant_;
 
   decltype(&Grounder::select_most_frequent) parameter_selector_;
   std::shared_ptr<normalized::Problem> problem_;
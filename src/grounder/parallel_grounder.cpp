@@ -8,10 +8,10 @@
 #include <algorithm>
 #include <atomic>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <mutex>
-#include <thread>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -24,7 +24,8 @@ ParallelGrounder::ParallelGrounder(
       init_(problem->predicates.size()), goal_(problem->predicates.size()),
       action_grounded_(problem->actions.size(), false),
       successful_cache_(problem->predicates.size()),
-      unsuccessful_cache_(problem->predicates.size()), problem_{problem} {
+      unsuccessful_cache_(problem->predicates.size()), problem_{problem},
+      pool_{num_threads} {
   num_actions_ =
       std::accumulate(problem_->actions.begin(), problem_->actions.end(), 0ul,
                       [this](uint_fast64_t sum, const auto &a) {
@@ -63,7 +64,7 @@ ParallelGrounder::ParallelGrounder(
   actions_.reserve(problem_->actions.size());
 
   for (const auto &action : problem_->actions) {
-    actions_.push_back({action});
+    actions_.emplace_back(std::vector<Action>{action});
   }
 
   prune_actions(num_threads);
@@ -127,77 +128,126 @@ void ParallelGrounder::refine(float groundness, util::Seconds timeout,
     LOG_INFO(grounder_logger, "Current groundness: %.3f", groundness_);
     LOG_INFO(grounder_logger, "Current actions: %lu actions",
              get_num_actions());
-    std::atomic_bool keep_grounding = false;
+    // The partial actions of all schemas are refined at once, the results are
+    // stored per task to keep their order independent of the scheduling
+    std::vector<size_t> schemas;
+    std::vector<size_t> task_offsets{0};
     for (size_t i = 0; i < actions_.size(); ++i) {
-      if (action_grounded_[i]) {
-        continue;
+      if (!action_grounded_[i]) {
+        schemas.push_back(i);
+        task_offsets.push_back(task_offsets.back() + actions_[i].size());
       }
-      std::atomic_bool action_grounded = true;
-      std::vector<Action> new_actions;
-      std::mutex new_actions_mutex;
-      std::atomic_uint_fast64_t new_pruned_actions = 0;
-      std::vector<std::thread> threads(num_threads);
-      std::atomic_uint_fast64_t index_counter = 0;
-      std::for_each(threads.begin(), threads.end(), [&](auto &t) {
-        t = std::thread{[&]() {
-          std::vector<normalized::Action> thread_new_actions;
-          uint_fast64_t action_index;
-          while ((action_index = index_counter.fetch_add(
-                      1, std::memory_order_relaxed)) < actions_[i].size()) {
-            if (config.global_stop_flag.load(std::memory_order_acquire)) {
-              return;
-            }
-            if (timeout != util::inf_time &&
-                timer.get_elapsed_time() > timeout) {
-              return;
-            }
-            if (config.timeout != util::inf_time &&
-                global_timer.get_elapsed_time() > config.timeout) {
-              throw TimeoutException{};
-            }
-            const auto &action = actions_[i][action_index];
-            auto selection = std::invoke(parameter_selector_, *this, action);
-            if (!selection.empty()) {
-              action_grounded = false;
-            }
-            for (auto it = AssignmentIterator{selection, action, *problem_};
-                 it != AssignmentIterator{}; ++it) {
-              auto [new_action, valid] = ground(action, *it);
-              if (valid) {
-                thread_new_actions.push_back(new_action);
-              } else {
-                new_pruned_actions.fetch_add(
-                    get_num_instantiated(new_action, *problem_),
-                    std::memory_order_relaxed);
-              }
-            };
-          }
-          std::lock_guard l{new_actions_mutex};
-          new_actions.insert(
-              new_actions.end(),
-              std::make_move_iterator(thread_new_actions.begin()),
-              std::make_move_iterator(thread_new_actions.end()));
-        }};
-      });
-      std::for_each(threads.begin(), threads.end(), [](auto &t) { t.join(); });
-      if (config.global_stop_flag.load(std::memory_order_acquire)) {
+    }
+    auto num_tasks = task_offsets.back();
+    std::vector<std::vector<Action>> new_actions(num_tasks);
+    std::vector<uint_fast64_t> new_pruned_actions(num_tasks, 0);
+    std::vector<char> refined(num_tasks, false);
+    std::vector<std::atomic_size_t> remaining_tasks(schemas.size());
+    for (size_t s = 0; s < schemas.size(); ++s) {
+      remaining_tasks[s].store(task_offsets[s + 1] - task_offsets[s],
+                               std::memory_order_relaxed);
+    }
+
+    // As in the sequential grounder, schemas are committed in order until the
+    // target groundness is reached. The cutoff is tracked as schemas finish,
+    // so that the tasks of the following schemas can be skipped.
+    std::mutex commit_mutex;
+    std::vector<char> schema_finished(schemas.size(), false);
+    size_t num_finished = 0;
+    std::atomic_size_t cutoff = schemas.size();
+    auto num_covered = get_num_actions() + num_pruned_actions_;
+    auto finish_schema = [&](size_t s) {
+      std::lock_guard l{commit_mutex};
+      schema_finished[s] = true;
+      while (num_finished < cutoff && schema_finished[num_finished]) {
+        auto first = task_offsets[num_finished];
+        auto last = task_offsets[num_finished + 1];
+        num_covered -= actions_[schemas[num_finished]].size();
+        for (auto task = first; task < last; ++task) {
+          num_covered += new_actions[task].size() + new_pruned_actions[task];
+        }
+        ++num_finished;
+        if (static_cast<float>(num_covered) /
+                static_cast<float>(num_actions_) >=
+            groundness) {
+          cutoff = num_finished;
+        }
+      }
+    };
+    for (size_t s = 0; s < schemas.size(); ++s) {
+      if (task_offsets[s] == task_offsets[s + 1]) {
+        finish_schema(s);
+      }
+    }
+
+    std::atomic_bool interrupted = false;
+    pool_.run(num_tasks, num_threads, [&](size_t task, unsigned int) {
+      auto s = static_cast<size_t>(
+          std::distance(task_offsets.begin(),
+                        std::upper_bound(task_offsets.begin(),
+                                         task_offsets.end(), task)) -
+          1);
+      if (s >= cutoff.load(std::memory_order_relaxed) ||
+          interrupted.load(std::memory_order_relaxed)) {
         return;
       }
-      if (action_grounded) {
-        action_grounded_[i] = true;
-      } else {
+      if (config.global_stop_flag.load(std::memory_order_acquire) ||
+          (timeout != util::inf_time && timer.get_elapsed_time() > timeout)) {
+        interrupted = true;
+        return;
+      }
+      if (config.timeout != util::inf_time &&
+          global_timer.get_elapsed_time() > config.timeout) {
+        throw TimeoutException{};
+      }
+      const auto &action = actions_[schemas[s]][task - task_offsets[s]];
+      auto selection = std::invoke(parameter_selector_, *this, action);
+      refined[task] = !selection.empty();
+      for (auto it = AssignmentIterator{selection, action, *problem_};
+           it != AssignmentIterator{}; ++it) {
+        auto [new_action, valid] = ground(action, *it);
+        if (valid) {
+          new_actions[task].push_back(std::move(new_action));
+        } else {
+          new_pruned_actions[task] +=
+              get_num_instantiated(new_action, *problem_);
+        }
+      }
+      if (remaining_tasks[s].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finish_schema(s);
+      }
+    });
+    if (config.global_stop_flag.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    // Only the finished schemas up to the cutoff are committed, so an
+    // interrupted round keeps the remaining schemas unchanged
+    bool keep_grounding = false;
+    for (size_t s = 0; s < num_finished; ++s) {
+      auto i = schemas[s];
+      auto first = task_offsets[s];
+      auto last = task_offsets[s + 1];
+      if (std::any_of(refined.begin() + static_cast<std::ptrdiff_t>(first),
+                      refined.begin() + static_cast<std::ptrdiff_t>(last),
+                      [](char r) { return r; })) {
         keep_grounding = true;
+      } else {
+        action_grounded_[i] = true;
       }
-      num_pruned_actions_ += new_pruned_actions;
-      actions_[i] = std::move(new_actions);
+      std::vector<Action> actions;
+      for (auto task = first; task < last; ++task) {
+        num_pruned_actions_ += new_pruned_actions[task];
+        actions.insert(actions.end(),
+                       std::make_move_iterator(new_actions[task].begin()),
+                       std::make_move_iterator(new_actions[task].end()));
+      }
+      actions_[i] = std::move(actions);
       groundness_ =
           static_cast<float>(get_num_actions() + num_pruned_actions_) /
           static_cast<float>(num_actions_);
-      if (groundness_ >= groundness) {
-        break;
-      }
     }
-    if (!keep_grounding) {
+    if (interrupted || !keep_grounding) {
       return;
     }
     prune_actions(num_threads);
@@ -431,36 +481,55 @@ void ParallelGrounder::prune_actions(unsigned int num_threads) noexcept {
         c.useless.clear();
       }
     }
+    std::vector<size_t> task_offsets{0};
+    for (const auto &actions : actions_) {
+      task_offsets.push_back(task_offsets.back() + actions.size());
+    }
+    auto num_tasks = task_offsets.back();
+    std::vector<Action> new_actions(num_tasks);
+    std::vector<char> valid(num_tasks, false);
+    // Whether the action was pruned or simplified
+    std::vector<char> modified(num_tasks, false);
+    std::atomic_uint_fast64_t new_pruned_actions = 0;
+    pool_.run(num_tasks, num_threads, [&](size_t task, unsigned int) {
+      auto i = static_cast<size_t>(
+          std::distance(task_offsets.begin(),
+                        std::upper_bound(task_offsets.begin(),
+                                         task_offsets.end(), task)) -
+          1);
+      const auto &action = actions_[i][task - task_offsets[i]];
+      if (is_valid(action)) {
+        new_actions[task] = action;
+        if (simplify(new_actions[task])) {
+          modified[task] = true;
+          changed = true;
+        }
+        valid[task] = true;
+      } else {
+        new_pruned_actions += get_num_instantiated(action, *problem_);
+        modified[task] = true;
+        changed = true;
+      }
+    });
+    // Schemas without pruned or simplified actions keep their block, which
+    // may be shared with extracted problems
     for (size_t i = 0; i < actions_.size(); ++i) {
-      std::vector<Action> new_actions;
-      std::mutex new_actions_mutex;
-      std::vector<std::thread> threads(num_threads);
-      std::atomic_uint_fast64_t new_pruned_actions = 0;
-      std::atomic_uint_fast64_t index_counter = 0;
-      std::for_each(threads.begin(), threads.end(), [&](auto &t) {
-        t = std::thread{[&]() {
-          uint_fast64_t action_index;
-          while ((action_index = index_counter.fetch_add(
-                      1, std::memory_order_relaxed)) < actions_[i].size()) {
-            const auto &action = actions_[i][action_index];
-            if (is_valid(action)) {
-              auto new_action = action;
-              if (simplify(new_action)) {
-                changed = true;
-              }
-              std::lock_guard l{new_actions_mutex};
-              new_actions.push_back(std::move(new_action));
-            } else {
-              new_pruned_actions += get_num_instantiated(action, *problem_);
-              changed = true;
-            }
-          }
-        }};
-      });
-      std::for_each(threads.begin(), threads.end(), [](auto &t) { t.join(); });
-      actions_[i] = std::move(new_actions);
-      num_pruned_actions_ += new_pruned_actions;
+      if (std::none_of(
+              modified.begin() + static_cast<std::ptrdiff_t>(task_offsets[i]),
+              modified.begin() +
+                  static_cast<std::ptrdiff_t>(task_offsets[i + 1]),
+              [](char m) { return m; })) {
+        continue;
+      }
+      std::vector<Action> actions;
+      for (auto task = task_offsets[i]; task < task_offsets[i + 1]; ++task) {
+        if (valid[task]) {
+          actions.push_back(std::move(new_actions[task]));
+        }
+      }
+      actions_[i] = std::move(actions);
     }
+    num_pruned_actions_ += new_pruned_actions;
   } while (changed);
 }
 
@@ -620,10 +689,8 @@ std::shared_ptr<Problem> ParallelGrounder::extract_problem() const noexcept {
   std::copy_if(problem_->goal.begin(), problem_->goal.end(),
                std::back_inserter(preprocessed_problem->goal),
                [this](const auto &g) { return !is_rigid(g.first, g.second); });
-  for (size_t i = 0; i < problem_->actions.size(); ++i) {
-    for (auto &action : actions_[i]) {
-      preprocessed_problem->actions.push_back(std::move(action));
-    }
+  for (const auto &actions : actions_) {
+    preprocessed_problem->actions.append(actions);
   }
   preprocessed_problem->action_names = problem_->action_names;
 
@@ -7,13 +7,14 @@
 #include "model/normalized/utils.hpp"
 #include "planner/planner.hpp"
 #include "util/index.hpp"
+#include "util/sharded_set.hpp"
+#include "util/shared_vector.hpp"
+#include "util/thread_pool.hpp"
 #include "util/timer.hpp"
 
 #include <algorithm>
 #include <atomic>
 #include <cstdint>
-#include <mutex>
-#include <unordered_set>
 #include <utility>
 
 extern logging::Logger grounder_logger;
@@ -53,26 +54,19 @@ private:
       noexcept {
     auto &rigid = (positive ? successful_cache_[atom.predicate].pos_rigid
                             : successful_cache_[atom.predicate].neg_rigid);
-    auto &rigid_mutex =
-        (positive ? successful_cache_[atom.predicate].pos_rigid_mutex
-                  : successful_cache_[atom.predicate].neg_rigid_mutex);
     auto &not_rigid =
         (positive ? unsuccessful_cache_[atom.predicate].pos_rigid
                   : unsuccessful_cache_[atom.predicate].neg_rigid);
-    auto &not_rigid_mutex =
-        (positive ? unsuccessful_cache_[atom.predicate].pos_rigid_mutex
-                  : unsuccessful_cache_[atom.predicate].neg_rigid_mutex);
     auto id = get_id(atom);
 
     if (cache_success) {
-      if (std::lock_guard l{rigid_mutex}; rigid.find(id) != rigid.end()) {
+      if (rigid.contains(id)) {
         return true;
       }
     }
 
     if (cache_fail) {
-      if (std::lock_guard l{not_rigid_mutex};
-          not_rigid.find(id) != not_rigid.end()) {
+      if (not_rigid.contains(id)) {
         return false;
       }
     }
@@ -80,7 +74,6 @@ private:
     if (std::binary_search(init_[atom.predicate].begin(),
                            init_[atom.predicate].end(), id) != positive) {
       if (cache_fail) {
-        std::lock_guard l{not_rigid_mutex};
         not_rigid.insert(id);
       }
       return false;
@@ -88,7 +81,6 @@ private:
 
     if (trivially_rigid_[atom.predicate]) {
       if (cache_success) {
-        std::lock_guard l{rigid_mutex};
         rigid.insert(id);
       }
       return true;
@@ -96,7 +88,6 @@ private:
 
     if (config.pruning_policy == Config::PruningPolicy::Trivial) {
       if (cache_fail) {
-        std::lock_guard l{not_rigid_mutex};
         not_rigid.insert(id);
       }
       return false;
@@ -110,7 +101,6 @@ private:
       for (const auto &action : actions_[i]) {
         if (has_effect(action, atom, !positive)) {
           if (cache_fail) {
-            std::lock_guard l{not_rigid_mutex};
             not_rigid.insert(id);
           }
           return false;
@@ -118,7 +108,6 @@ private:
       }
     }
     if (cache_success) {
-      std::lock_guard l{rigid_mutex};
       rigid.insert(id);
     }
     return true;
@@ -131,20 +120,17 @@ private:
   template <bool cache_success, bool cache_fail>
   bool is_useless(const normalized::GroundAtom &atom) const noexcept {
     auto &useless = successful_cache_[atom.predicate].useless;
-    auto &useless_mutex = successful_cache_[atom.predicate].useless_mutex;
     auto &not_useless = unsuccessful_cache_[atom.predicate].useless;
-    auto &not_useless_mutex = unsuccessful_cache_[atom.predicate].useless_mutex;
     auto id = get_id(atom);
 
     if (cache_success) {
-      if (std::lock_guard l{useless_mutex}; useless.find(id) != useless.end()) {
+      if (useless.contains(id)) {
         return true;
       }
     }
 
     if (cache_fail) {
-      if (std::lock_guard l{not_useless_mutex};
-          not_useless.find(id) != not_useless.end()) {
+      if (not_useless.contains(id)) {
         return false;
       }
     }
@@ -152,7 +138,6 @@ private:
     if (std::binary_search(goal_[atom.predicate].begin(),
                            goal_[atom.predicate].end(), id)) {
       if (cache_fail) {
-        std::lock_guard l{not_useless_mutex};
         not_useless.insert(id);
       }
       return false;
@@ -160,7 +145,6 @@ private:
 
     if (trivially_useless_[atom.predicate]) {
       if (cache_success) {
-        std::lock_guard l{useless_mutex};
         useless.insert(id);
       }
       return true;
@@ -168,7 +152,6 @@ private:
 
     if (config.pruning_policy == Config::PruningPolicy::Trivial) {
       if (cache_fail) {
-        std::lock_guard l{not_useless_mutex};
         not_useless.insert(id);
       }
       return false;
@@ -180,7 +163,6 @@ private:
         for (const auto &action : actions_[i]) {
           if (has_precondition(action, atom)) {
             if (cache_fail) {
-              std::lock_guard l{not_useless_mutex};
               not_useless.insert(id);
             }
             return false;
@@ -189,7 +171,6 @@ private:
       }
     }
     if (cache_success) {
-      std::lock_guard l{useless_mutex};
       useless.insert(id);
     }
     return true;
@@ -220,7 +201,8 @@ private:
   float groundness_;
   uint_fast64_t num_actions_;
   uint_fast64_t num_pruned_actions_ = 0;
-  std::vector<std::vector<normalized::Action>> actions_;
+  // Actions by schema, shared with the extracted problems
+  std::vector<util::SharedVector<normalized::Action>> actions_;
   std::vector<bool> trivially_rigid_;
   std::vector<bool> trivially_useless_;
   std::vector<std::vector<PredicateId>> init_;
@@ -228,12 +210,9 @@ private:
   std::vector<bool> action_grounded_;
 
   struct Cache {
-    std::unordered_set<PredicateId> pos_rigid;
-    std::unordered_set<PredicateId> neg_rigid;
-    std::unordered_set<PredicateId> useless;
-    std::mutex pos_rigid_mutex;
-    std::mutex neg_rigid_mutex;
-    std::mutex useless_mutex;
+    util::ShardedSet<PredicateId> pos_rigid{config.cache_shards};
+    util::ShardedSet<PredicateId> neg_rigid{config.cache_shards};
+    util::ShardedSet<PredicateId> useless{config.cache_shards};
   };
 
   mutable std::vector<Cache> successful_cache_;
@@ -241,6 +220,9 @@ private:
 
   decltype(&ParallelGrounder::select_most_frequent) parameter_selector_;
   std::shared_ptr<normalized::Problem> problem_;
+  // Shared by refine and prune_actions, whose tasks are the partial actions
+  // of all schemas
+  util::ThreadPool pool_;
 };
 
 #endif /* end of include guard: PARALLEL_PREPROCESS_HPP */
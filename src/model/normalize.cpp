@@ -9,6 +9,8 @@
 #include <memory>
 #include <optional>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -162,59 +164,72 @@ std::shared_ptr<normalized::Problem> normalize(const parsed::Problem &problem) {
   normalized_problem->domain_name = problem.get_domain_name();
   normalized_problem->problem_name = problem.get_problem_name();
   normalized_problem->requirements = problem.get_requirements();
-  normalized_problem->types.reserve(problem.get_types().size());
-  normalized_problem->type_names.reserve(problem.get_types().size());
+  std::vector<normalized::Type> types;
+  std::vector<std::string> type_names;
+  types.reserve(problem.get_types().size());
+  type_names.reserve(problem.get_types().size());
 
   for (const auto &t : problem.get_types()) {
-    normalized_problem->types.push_back(normalized::Type{
+    types.push_back(normalized::Type{
         normalized::TypeIndex{problem.get_index(t->supertype)}});
-    normalized_problem->type_names.push_back(t->name);
+    type_names.push_back(t->name);
   }
 
+  std::vector<normalized::Constant> constants;
+  std::vector<std::string> constant_names;
   for (const auto &c : problem.get_constants()) {
-    normalized_problem->constants.push_back(normalized::Constant{
+    constants.push_back(normalized::Constant{
         normalized::TypeIndex{problem.get_index(c->type)}});
-    normalized_problem->constant_names.push_back(c->name);
+    constant_names.push_back(c->name);
   }
 
-  normalized_problem->constants_of_type.resize(
-      normalized_problem->types.size());
-  normalized_problem->constant_type_map.resize(
-      normalized_problem->types.size());
-  for (size_t i = 0; i < normalized_problem->constants.size(); ++i) {
+  std::vector<std::vector<normalized::ConstantIndex>> constants_of_type(
+      types.size());
+  std::vector<std::unordered_map<normalized::ConstantIndex, size_t>>
+      constant_type_map(types.size());
+  for (size_t i = 0; i < constants.size(); ++i) {
     auto constant_index = normalized::ConstantIndex{i};
-    auto type = normalized_problem->constants[i].type;
-    normalized_problem->constant_type_map[type][constant_index] =
-        normalized_problem->constants_of_type[type].size();
-    normalized_problem->constants_of_type[type].emplace_back(i);
-    while (normalized_problem->types[type].supertype != type) {
-      type = normalized_problem->types[type].supertype;
-      normalized_problem->constant_type_map[type][constant_index] =
-          normalized_problem->constants_of_type[type].size();
-      normalized_problem->constants_of_type[type].emplace_back(i);
+    auto type = constants[i].type;
+    constant_type_map[type][constant_index] = constants_of_type[type].size();
+    constants_of_type[type].emplace_back(i);
+    while (types[type].supertype != type) {
+      type = types[type].supertype;
+      constant_type_map[type][constant_index] = constants_of_type[type].size();
+      constants_of_type[type].emplace_back(i);
     }
   }
 
+  std::vector<normalized::Predicate> predicates;
+  std::vector<std::string> predicate_names;
   for (const auto &predicate : problem.get_predicates()) {
     normalized::Predicate new_predicate{};
     for (const auto &t : predicate->parameter_types) {
       new_predicate.parameter_types.emplace_back(problem.get_index(t));
     }
-    normalized_problem->predicates.push_back(std::move(new_predicate));
-    normalized_problem->predicate_names.push_back(predicate->name);
+    predicates.push_back(std::move(new_predicate));
+    predicate_names.push_back(predicate->name);
   }
 
+  normalized_problem->types = std::move(types);
+  normalized_problem->type_names = std::move(type_names);
+  normalized_problem->constants = std::move(constants);
+  normalized_problem->constant_names = std::move(constant_names);
+  normalized_problem->constants_of_type = std::move(constants_of_type);
+  normalized_problem->constant_type_map = std::move(constant_type_map);
+  normalized_problem->predicates = std::move(predicates);
+  normalized_problem->predicate_names = std::move(predicate_names);
+
   LOG_INFO(normalize_logger, "Normalizing init...");
 
+  std::vector<normalized::GroundAtom> positive_init;
   std::vector<normalized::GroundAtom> negative_init;
   for (const auto &init : problem.get_init()) {
     auto ground_atom =
         as_ground_atom(normalize_atomic_condition(*init, problem).atom);
     if (init->positive()) {
-      if (std::find(normalized_problem->init.begin(),
-                    normalized_problem->init.end(),
-                    ground_atom) == normalized_problem->init.end()) {
-        normalized_problem->init.push_back(ground_atom);
+      if (std::find(positive_init.begin(), positive_init.end(),
+                    ground_atom) == positive_init.end()) {
+        positive_init.push_back(ground_atom);
       } else {
         LOG_WARN(normalize_logger, "Found duplicate init atom '%s'",
                  to_string(ground_atom, *normalized_problem).c_str());
@@ -231,9 +246,8 @@ std::shared_ptr<normalized::Problem> normalize(const parsed::Problem &problem) {
   }
 
   for (const auto &atom : negative_init) {
-    if (std::find(normalized_problem->init.begin(),
-                  normalized_problem->init.end(),
-                  atom) != normalized_problem->init.end()) {
+    if (std::find(positive_init.begin(), positive_init.end(), atom) !=
+        positive_init.end()) {
       LOG_ERROR(normalize_logger, "Found conflicting init atom '%s'",
                 to_string(atom, *normalized_problem).c_str());
       return std::shared_ptr<normalized::Problem>();
@@ -241,13 +255,14 @@ std::shared_ptr<normalized::Problem> normalize(const parsed::Problem &problem) {
   }
 
   // Reserve space for initial and equality predicates
-  normalized_problem->init.reserve(normalized_problem->init.size() +
-                                   normalized_problem->constants.size());
+  positive_init.reserve(positive_init.size() +
+                        normalized_problem->constants.size());
   for (size_t i = 0; i < normalized_problem->constants.size(); ++i) {
-    normalized_problem->init.push_back(normalized::GroundAtom{
+    positive_init.push_back(normalized::GroundAtom{
         normalized::PredicateIndex{0},
         {normalized::ConstantIndex{i}, normalized::ConstantIndex{i}}});
   }
+  normalized_problem->init = std::move(positive_init);
 
   LOG_INFO(normalize_logger, "Normalizing goal...");
 
@@ -277,17 +292,20 @@ std::shared_ptr<normalized::Problem> normalize(const parsed::Problem &problem) {
 
   LOG_INFO(normalize_logger, "Normalizing actions...");
 
+  std::vector<normalized::Action> actions;
+  std::vector<std::string> action_names;
   for (const auto &action : problem.get_actions()) {
     auto new_actions = normalize_action(*action, problem);
     for (const auto &a : new_actions) {
       if (get_num_instantiated(a, *normalized_problem) > 0) {
-        normalized_problem->actions.push_back(a);
-        normalized_problem->actions.back().id =
-            normalized_problem->actions.size() - 1;
-        normalized_problem->action_names.push_back(action->name);
+        actions.push_back(a);
+        actions.back().id = actions.size() - 1;
+        action_names.push_back(action->name);
       }
     }
   }
+  normalized_problem->actions = std::move(actions);
+  normalized_problem->action_names = std::move(action_names);
 
   return normalized_problem;
 }
@@ -1,7 +1,9 @@
 #ifndef NORMALIZE_MODEL_HPP
 #define NORMALIZE_MODEL_HPP
 
+#include "util/block_vector.hpp"
 #include "util/index.hpp"
+#include "util/shared_vector.hpp"
 #include "util/tagged_union.hpp"
 
 #include <cassert>
@@ -89,21 +91,25 @@ struct Action {
   std::vector<std::pair<GroundAtom, bool>> ground_effects;
 };
 
+// The parts that do not change when grounding are shared between the problems
+// extracted by the grounders, only the goal is per problem. The actions are
+// shared in blocks, one per action schema that did not change in between.
 struct Problem {
   std::string domain_name;
   std::string problem_name;
   std::vector<std::string> requirements;
-  std::vector<Type> types;
-  std::vector<std::string> type_names;
-  std::vector<Constant> constants;
-  std::vector<std::string> constant_names;
-  std::vector<std::vector<ConstantIndex>> constants_of_type;
-  std::vector<std::unordered_map<ConstantIndex, size_t>> constant_type_map;
-  std::vector<Predicate> predicates;
-  std::vector<std::string> predicate_names;
-  std::vector<Action> actions;
-  std::vector<std::string> action_names;
-  std::vector<GroundAtom> init;
+  util::SharedVector<Type> types;
+  util::SharedVector<std::string> type_names;
+  util::SharedVector<Constant> constants;
+  util::SharedVector<std::string> constant_names;
+  util::SharedVector<std::vector<ConstantIndex>> constants_of_type;
+  util::SharedVector<std::unordered_map<ConstantIndex, size_t>>
+      constant_type_map;
+  util::SharedVector<Predicate> predicates;
+  util::SharedVector<std::string> predicate_names;
+  util::BlockVector<Action> actions;
+  util::SharedVector<std::string> action_names;
+  util::SharedVector<GroundAtom> init;
   std::vector<std::pair<GroundAtom, bool>> goal;
 
   TypeIndex get_index(const Type *type) const noexcept {
@@ -116,7 +122,7 @@ struct Problem {
     return {static_cast<size_t>(std::distance(&predicates.front(), predicate))};
   }
   ActionIndex get_index(const Action *action) const noexcept {
-    return {static_cast<size_t>(std::distance(&actions.front(), action))};
+    return {actions.index_of(action)};
   }
 
   const std::string &get_name(TypeIndex type) const noexcept {
@@ -8,7 +8,9 @@
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <numeric>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -148,10 +150,10 @@ inline size_t get_num_instantiated(const Predicate &predicate,
       });
 }
 
-inline size_t get_num_instantiated(const Action &action,
+inline size_t get_num_instantiated(const std::vector<Parameter> &parameters,
                                    const Problem &problem) noexcept {
   return std::accumulate(
-      action.parameters.begin(), action.parameters.end(), 1ul,
+      parameters.begin(), parameters.end(), 1ul,
       [&problem](size_t product, const Parameter &p) {
         if (!p.is_free()) {
           return product;
@@ -160,6 +162,11 @@ inline size_t get_num_instantiated(const Action &action,
       });
 }
 
+inline size_t get_num_instantiated(const Action &action,
+                                   const Problem &problem) noexcept {
+  return get_num_instantiated(action.parameters, problem);
+}
+
 inline size_t get_num_instantiated(const ParameterSelection &selection,
                                    const Action &action,
                                    const Problem &problem) noexcept {
@@ -249,6 +256,151 @@ public:
   }
 };
 
+// Restrictions on the constants assigned to the parameters of a selection
+struct AssignmentConstraints {
+  // Allowed constants for each position in the selection, sorted
+  std::vector<std::vector<ConstantIndex>> domains;
+
+  // The sorted constants at position second that are compatible with each
+  // constant at position first. The first position is always the larger one.
+  struct Support {
+    size_t first;
+    size_t second;
+    std::unordered_map<ConstantIndex, std::vector<ConstantIndex>> values;
+  };
+
+  std::vector<Support> supports;
+};
+
+// Enumerates the assignments to a selection that satisfy the constraints, in
+// the same order as AssignmentIterator. The positions are assigned from the
+// last to the first, and each position only tries the constants supported by
+// the constants already assigned.
+class ConstrainedAssignmentIterator {
+  ParameterAssignment assignment_;
+  const AssignmentConstraints *constraints_ = nullptr;
+  std::vector<const std::vector<ConstantIndex> *> candidates_;
+  std::vector<size_t> indices_;
+  bool is_end_ = true;
+
+  void set_candidates(size_t i) noexcept {
+    static const std::vector<ConstantIndex> no_candidates;
+    candidates_[i] = &constraints_->domains[i];
+    for (const auto &support : constraints_->supports) {
+      if (support.second != i) {
+        continue;
+      }
+      auto it = support.values.find(assignment_[support.first].second);
+      if (it == support.values.end()) {
+        candidates_[i] = &no_candidates;
+        return;
+      }
+      if (it->second.size() < candidates_[i]->size()) {
+        candidates_[i] = &it->second;
+      }
+    }
+  }
+
+  bool is_consistent(size_t i, ConstantIndex constant) const noexcept {
+    const auto &domain = constraints_->domains[i];
+    if (candidates_[i] != &domain &&
+        !std::binary_search(domain.begin(), domain.end(), constant)) {
+      return false;
+    }
+    for (const auto &support : constraints_->supports) {
+      if (support.second != i) {
+        continue;
+      }
+      const auto &values =
+          support.values.at(assignment_[support.first].second);
+      if (&values != candidates_[i] &&
+          !std::binary_search(values.begin(), values.end(), constant)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Moves position i to its next consistent constant, going back to the
+  // later positions when it has none left
+  void advance(size_t i) noexcept {
+    while (true) {
+      const auto &candidates = *candidates_[i];
+      auto &index = indices_[i];
+      do {
+        ++index;
+      } while (index < candidates.size() &&
+               !is_consistent(i, candidates[index]));
+      if (index < candidates.size()) {
+        assignment_[i].second = candidates[index];
+        if (i == 0) {
+          return;
+        }
+        --i;
+        set_candidates(i);
+        indices_[i] = std::numeric_limits<size_t>::max();
+      } else if (i + 1 == assignment_.size()) {
+        is_end_ = true;
+        return;
+      } else {
+        ++i;
+      }
+    }
+  }
+
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = ParameterAssignment;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const value_type *;
+  using reference = const value_type &;
+
+  explicit ConstrainedAssignmentIterator() noexcept = default;
+
+  explicit ConstrainedAssignmentIterator(
+      const ParameterSelection &selection,
+      const AssignmentConstraints &constraints) noexcept
+      : assignment_(selection.size()), constraints_{&constraints},
+        candidates_(selection.size()), indices_(selection.size()),
+        is_end_{false} {
+    assert(constraints.domains.size() == selection.size());
+    for (size_t i = 0; i < selection.size(); ++i) {
+      assignment_[i].first = selection[i];
+    }
+    if (!selection.empty()) {
+      set_candidates(selection.size() - 1);
+      indices_.back() = std::numeric_limits<size_t>::max();
+      advance(selection.size() - 1);
+    }
+  }
+
+  ConstrainedAssignmentIterator &operator++() noexcept {
+    assert(constraints_);
+    if (assignment_.empty()) {
+      is_end_ = true;
+    } else if (!is_end_) {
+      advance(0);
+    }
+    return *this;
+  }
+
+  ConstrainedAssignmentIterator operator++(int) noexcept {
+    auto old = *this;
+    ++(*this);
+    return old;
+  }
+
+  inline reference operator*() const noexcept { return assignment_; }
+
+  bool operator!=(const ConstrainedAssignmentIterator &) const noexcept {
+    return !is_end_;
+  }
+
+  bool operator==(const ConstrainedAssignmentIterator &) const noexcept {
+    return is_end_;
+  }
+};
+
 class GroundAtomIterator {
   GroundAtom ground_atom_;
   ParameterMapping mapping_;
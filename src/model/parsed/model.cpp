@@ -4,6 +4,7 @@
 #include <cassert>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -56,11 +57,11 @@ void Action::set_effect(std::shared_ptr<Effect> effect) {
   this->effect = std::move(effect);
 }
 
-ParameterHandle Action::get_parameter(const std::string &name) const {
+ParameterHandle Action::get_parameter(std::string_view name) const {
   auto it = std::find_if(parameters.begin(), parameters.end(),
                          [&name](const auto &p) { return p->name == name; });
   if (it == parameters.end()) {
-    throw ModelException{"Parameter \'" + name + "\' not found"};
+    throw ModelException{"Parameter \'" + std::string{name} + "\' not found"};
   }
   return {it->get(), this};
 }
@@ -85,13 +86,12 @@ void Problem::set_problem_name(std::string name,
 }
 
 TypeHandle Problem::add_type(std::string name) {
-  if (std::find_if(types_.begin(), types_.end(), [&name](const auto &t) {
-        return t->name == name;
-      }) != types_.end()) {
+  if (type_indices_.count(name) > 0) {
     throw ModelException{"Type \'" + name + "\' already exists"};
   }
   types_.push_back(std::make_unique<Type>(Type{std::move(name), nullptr}));
   types_.back()->supertype = types_.back().get();
+  type_indices_.emplace(types_.back()->name, types_.size() - 1);
   return {types_.back().get(), this};
 }
 
@@ -99,13 +99,12 @@ TypeHandle Problem::add_type(std::string name, TypeHandle supertype) {
   if (this != supertype.get_base()) {
     throw ModelException{"Supertype is not from this problem"};
   }
-  if (std::find_if(types_.begin(), types_.end(), [&name](const auto &t) {
-        return t->name == name;
-      }) != types_.end()) {
+  if (type_indices_.count(name) > 0) {
     throw ModelException{"Type \'" + name + "\' already exists"};
   }
   types_.push_back(
       std::make_unique<Type>(Type{std::move(name), supertype.get()}));
+  type_indices_.emplace(types_.back()->name, types_.size() - 1);
   return {types_.back().get(), this};
 }
 
@@ -113,23 +112,21 @@ ConstantHandle Problem::add_constant(std::string name, TypeHandle type) {
   if (this != type.get_base()) {
     throw ModelException{"Constant is not from this problem"};
   }
-  if (std::find_if(constants_.begin(), constants_.end(),
-                   [&name](const auto &c) { return c->name == name; }) !=
-      constants_.end()) {
+  if (constant_indices_.count(name) > 0) {
     throw ModelException{"Constant \'" + name + "\' already exists"};
   }
   constants_.push_back(
       std::make_unique<Constant>(Constant{std::move(name), type.get()}));
+  constant_indices_.emplace(constants_.back()->name, constants_.size() - 1);
   return {constants_.back().get(), this};
 }
 
 PredicateHandle Problem::add_predicate(std::string name) {
-  if (std::find_if(predicates_.begin(), predicates_.end(),
-                   [&name](const auto &p) { return p->name == name; }) !=
-      predicates_.end()) {
+  if (predicate_indices_.count(name) > 0) {
     throw ModelException{"Predicate \'" + name + "\' already exists"};
   }
   predicates_.push_back(std::make_unique<Predicate>(std::move(name)));
+  predicate_indices_.emplace(predicates_.back()->name, predicates_.size() - 1);
   return {predicates_.back().get(), this};
 }
 
@@ -144,12 +141,11 @@ void Problem::add_parameter_type(PredicateHandle predicate, TypeHandle type) {
 }
 
 ActionHandle Problem::add_action(std::string name) {
-  if (std::find_if(actions_.begin(), actions_.end(), [&name](const auto &a) {
-        return a->name == name;
-      }) != actions_.end()) {
+  if (action_indices_.count(name) > 0) {
     throw ModelException{"Action \'" + name + "\' already exists"};
   }
   actions_.push_back(std::make_unique<Action>(Action{std::move(name), this}));
+  action_indices_.emplace(actions_.back()->name, actions_.size() - 1);
   return {actions_.back().get(), this};
 }
 
@@ -194,44 +190,40 @@ void Problem::set_goal(std::shared_ptr<GoalCondition> goal) {
   goal_ = std::move(goal);
 }
 
-TypeHandle Problem::get_type(const std::string &name) const {
-  auto it = std::find_if(types_.begin(), types_.end(),
-                         [&name](const auto &t) { return t->name == name; });
-  if (it == types_.end()) {
+TypeHandle Problem::get_type(std::string_view name) const {
+  auto it = type_indices_.find(name);
+  if (it == type_indices_.end()) {
     if (name != "object") {
-      throw ModelException{"Type \'" + name + "\' not found"};
+      throw ModelException{"Type \'" + std::string{name} + "\' not found"};
     } else {
       return {types_.front().get(), this};
     }
   }
-  return {it->get(), this};
+  return {types_[it->second].get(), this};
 }
 
-ConstantHandle Problem::get_constant(const std::string &name) const {
-  auto it = std::find_if(constants_.begin(), constants_.end(),
-                         [&name](const auto &c) { return c->name == name; });
-  if (it == constants_.end()) {
-    throw ModelException{"Constant \'" + name + "\' not found"};
+ConstantHandle Problem::get_constant(std::string_view name) const {
+  auto it = constant_indices_.find(name);
+  if (it == constant_indices_.end()) {
+    throw ModelException{"Constant \'" + std::string{name} + "\' not found"};
   }
-  return {it->get(), this};
+  return {constants_[it->second].get(), this};
 }
 
-PredicateHandle Problem::get_predicate(const std::string &name) const {
-  auto it = std::find_if(predicates_.begin(), predicates_.end(),
-                         [&name](const auto &p) { return p->name == name; });
-  if (it == predicates_.end()) {
-    throw ModelException{"Predicate \'" + name + "\' not found"};
+PredicateHandle Problem::get_predicate(std::string_view name) const {
+  auto it = predicate_indices_.find(name);
+  if (it == predicate_indices_.end()) {
+    throw ModelException{"Predicate \'" + std::string{name} + "\' not found"};
   }
-  return {it->get(), this};
+  return {predicates_[it->second].get(), this};
 }
 
-ActionHandle Problem::get_action(const std::string &name) const {
-  auto it = std::find_if(actions_.begin(), actions_.end(),
-                         [&name](const auto &a) { return a->name == name; });
-  if (it == actions_.end()) {
-    throw ModelException{"Action \'" + name + "\' not found"};
+ActionHandle Problem::get_action(std::string_view name) const {
+  auto it = action_indices_.find(name);
+  if (it == action_indices_.end()) {
+    throw ModelException{"Action \'" + std::string{name} + "\' not found"};
   }
-  return {it->get(), this};
+  return {actions_[it->second].get(), this};
 }
 
 } // namespace parsed
@@ -10,6 +10,8 @@
 #include <iterator>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <variant>
 #include <vector>
 
@@ -351,6 +353,21 @@ size_t get_index(const T *elem,
                    [elem](const auto &e) { return e.get() == elem; })));
 }
 
+// Positions of the elements by name. The names are owned by the elements.
+using NameIndex = std::unordered_map<std::string_view, size_t>;
+
+template <typename T>
+size_t get_index(const T *elem, const std::vector<std::unique_ptr<T>> &list,
+                 const NameIndex &indices) noexcept {
+  if (elem != nullptr) {
+    if (auto it = indices.find(elem->name);
+        it != indices.end() && list[it->second].get() == elem) {
+      return it->second;
+    }
+  }
+  return list.size();
+}
+
 struct Action {
   friend Problem;
 
@@ -363,7 +380,7 @@ struct Action {
   ParameterHandle add_parameter(std::string name, TypeHandle type);
   void set_precondition(std::shared_ptr<Precondition> precondition);
   void set_effect(std::shared_ptr<Effect> effect);
-  ParameterHandle get_parameter(const std::string &name) const;
+  ParameterHandle get_parameter(std::string_view name) const;
 
   size_t get_index(const Parameter *parameter) const noexcept {
     return parsed::get_index(parameter, parameters);
@@ -384,6 +401,10 @@ class Problem {
   std::vector<std::unique_ptr<Action>> actions_;
   std::vector<std::shared_ptr<FreePredicate>> init_;
   std::shared_ptr<GoalCondition> goal_;
+  NameIndex type_indices_;
+  NameIndex constant_indices_;
+  NameIndex predicate_indices_;
+  NameIndex action_indices_;
 
 public:
   void set_domain_name(std::string name);
@@ -414,27 +435,27 @@ public:
   const auto &get_constants() const { return constants_; }
   const auto &get_predicates() const { return predicates_; }
   const auto &get_actions() const { return actions_; }
-  TypeHandle get_type(const std::string &name) const;
-  ConstantHandle get_constant(const std::string &name) const;
-  PredicateHandle get_predicate(const std::string &name) const;
-  ActionHandle get_action(const std::string &name) const;
+  TypeHandle get_type(std::string_view name) const;
+  ConstantHandle get_constant(std::string_view name) const;
+  PredicateHandle get_predicate(std::string_view name) const;
+  ActionHandle get_action(std::string_view name) const;
   const auto &get_init() const { return init_; }
   const auto &get_goal() const { return goal_; }
 
   size_t get_index(const Type *type) const noexcept {
-    return parsed::get_index(type, types_);
+    return parsed::get_index(type, types_, type_indices_);
   }
 
   size_t get_index(const Constant *constant) const noexcept {
-    return parsed::get_index(constant, constants_);
+    return parsed::get_index(constant, constants_, constant_indices_);
   }
 
   size_t get_index(const Predicate *predicate) const noexcept {
-    return parsed::get_index(predicate, predicates_);
+    return parsed::get_index(predicate, predicates_, predicate_indices_);
   }
 
   size_t get_index(const Action *action) const noexcept {
-    return parsed::get_index(action, actions_);
+    return parsed::get_index(action, actions_, action_indices_);
   }
 };
 
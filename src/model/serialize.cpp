@@ -0,0 +1,380 @@
+#include "model/serialize.hpp"
+#include "model/normalized/model.hpp"
+#include "util/mapped_file.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace normalized;
+
+namespace {
+
+// Identifies the file layout and has to be changed along with it
+constexpr uint64_t file_magic = 0x52504e5000000001;
+
+struct InvalidProblemFile {};
+
+class Writer {
+public:
+  void write(uint64_t value) { words_.push_back(value); }
+
+  void write(const std::string &s) {
+    write(s.size());
+    auto begin = words_.size();
+    words_.resize(begin + (s.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    std::memcpy(words_.data() + begin, s.data(), s.size());
+  }
+
+  void write(const Parameter &parameter) {
+    write(uint64_t{parameter.is_free()});
+    write(parameter.is_free() ? uint64_t{parameter.get_type()}
+                              : uint64_t{parameter.get_constant()});
+  }
+
+  void write(const Argument &argument) {
+    write(uint64_t{argument.is_parameter()});
+    write(argument.is_parameter() ? uint64_t{argument.get_parameter_index()}
+                                  : uint64_t{argument.get_constant()});
+  }
+
+  void write(const Condition &condition) {
+    write(uint64_t{condition.atom.predicate});
+    write(condition.atom.arguments);
+    write(uint64_t{condition.positive});
+  }
+
+  void write(const GroundAtom &atom) {
+    write(uint64_t{atom.predicate});
+    write(atom.arguments);
+  }
+
+  void write(const std::pair<GroundAtom, bool> &atom) {
+    write(atom.first);
+    write(uint64_t{atom.second});
+  }
+
+  template <typename T> void write(const util::Index<T> &index) {
+    write(uint64_t{index});
+  }
+
+  template <typename T> void write(const std::vector<T> &values) {
+    write(values.size());
+    for (const auto &value : values) {
+      write(value);
+    }
+  }
+
+  template <typename T> void write(const util::SharedVector<T> &values) {
+    write(values.get());
+  }
+
+  const std::vector<uint64_t> &get_words() const noexcept { return words_; }
+
+private:
+  std::vector<uint64_t> words_;
+};
+
+// Bounds checked sequential access to the words of a problem file
+class Reader {
+public:
+  explicit Reader(const util::MappedFile &file) noexcept
+      : words_{reinterpret_cast<const uint64_t *>(file.data())},
+        size_{file.size() / sizeof(uint64_t)} {}
+
+  uint64_t read() {
+    if (pos_ >= size_) {
+      throw InvalidProblemFile{};
+    }
+    return words_[pos_++];
+  }
+
+  // Reads a value not exceeding max
+  uint64_t read(uint64_t max) {
+    auto value = read();
+    if (value > max) {
+      throw InvalidProblemFile{};
+    }
+    return value;
+  }
+
+  uint64_t read_index(uint64_t num_indices) {
+    auto value = read();
+    if (value >= num_indices) {
+      throw InvalidProblemFile{};
+    }
+    return value;
+  }
+
+  // Every element takes at least one word, which bounds the allocations
+  uint64_t read_size() { return read(size_ - pos_); }
+
+  std::string read_string() {
+    auto length = read((size_ - pos_) * sizeof(uint64_t));
+    auto num_words = (length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (num_words > size_ - pos_) {
+      throw InvalidProblemFile{};
+    }
+    std::string s{reinterpret_cast<const char *>(words_ + pos_), length};
+    pos_ += num_words;
+    return s;
+  }
+
+  std::vector<std::string> read_strings() {
+    std::vector<std::string> strings(read_size());
+    for (auto &s : strings) {
+      s = read_string();
+    }
+    return strings;
+  }
+
+  bool at_end() const noexcept { return pos_ == size_; }
+
+private:
+  const uint64_t *words_;
+  size_t size_;
+  size_t pos_ = 0;
+};
+
+class ProblemReader {
+public:
+  ProblemReader(Reader &reader, Problem &problem) noexcept
+      : reader_{reader}, problem_{problem} {}
+
+  void read() {
+    if (reader_.read() != file_magic) {
+      throw InvalidProblemFile{};
+    }
+    problem_.domain_name = reader_.read_string();
+    problem_.problem_name = reader_.read_string();
+    problem_.requirements = reader_.read_strings();
+    read_types();
+    read_constants();
+    read_predicates();
+    problem_.action_names = reader_.read_strings();
+    std::vector<Action> actions(reader_.read_size());
+    for (auto &action : actions) {
+      read_action(action);
+    }
+    problem_.actions = std::move(actions);
+    std::vector<GroundAtom> init(reader_.read_size());
+    for (auto &atom : init) {
+      read_ground_atom(atom);
+    }
+    problem_.init = std::move(init);
+    read_ground_atoms(problem_.goal);
+    if (!reader_.at_end()) {
+      throw InvalidProblemFile{};
+    }
+  }
+
+private:
+  void read_types() {
+    std::vector<Type> types(reader_.read_size());
+    std::vector<std::string> type_names;
+    type_names.reserve(types.size());
+    for (auto &type : types) {
+      type.supertype = reader_.read_index(types.size());
+      type_names.push_back(reader_.read_string());
+    }
+    problem_.types = std::move(types);
+    problem_.type_names = std::move(type_names);
+  }
+
+  void read_constants() {
+    std::vector<Constant> constants(reader_.read_size());
+    std::vector<std::string> constant_names;
+    constant_names.reserve(constants.size());
+    for (auto &constant : constants) {
+      constant.type = reader_.read_index(problem_.types.size());
+      constant_names.push_back(reader_.read_string());
+    }
+    problem_.constants = std::move(constants);
+    problem_.constant_names = std::move(constant_names);
+
+    std::vector<std::vector<ConstantIndex>> constants_of_type(
+        problem_.types.size());
+    std::vector<std::unordered_map<ConstantIndex, size_t>> constant_type_map(
+        problem_.types.size());
+    for (size_t t = 0; t < constants_of_type.size(); ++t) {
+      constants_of_type[t].resize(reader_.read_size());
+      for (size_t i = 0; i < constants_of_type[t].size(); ++i) {
+        auto constant =
+            ConstantIndex{reader_.read_index(problem_.constants.size())};
+        constants_of_type[t][i] = constant;
+        if (!constant_type_map[t].try_emplace(constant, i).second) {
+          throw InvalidProblemFile{};
+        }
+      }
+    }
+    problem_.constants_of_type = std::move(constants_of_type);
+    problem_.constant_type_map = std::move(constant_type_map);
+  }
+
+  void read_predicates() {
+    std::vector<Predicate> predicates(reader_.read_size());
+    std::vector<std::string> predicate_names;
+    predicate_names.reserve(predicates.size());
+    for (auto &predicate : predicates) {
+      predicate.parameter_types.resize(reader_.read_size());
+      for (auto &type : predicate.parameter_types) {
+        type = reader_.read_index(problem_.types.size());
+      }
+      predicate_names.push_back(reader_.read_string());
+    }
+    problem_.predicates = std::move(predicates);
+    problem_.predicate_names = std::move(predicate_names);
+  }
+
+  void read_action(Action &action) {
+    action.id = reader_.read_index(problem_.action_names.size());
+    auto num_parameters = reader_.read_size();
+    action.parameters.reserve(num_parameters);
+    for (size_t i = 0; i < num_parameters; ++i) {
+      if (reader_.read(1) == 1) {
+        action.parameters.emplace_back(
+            TypeIndex{reader_.read_index(problem_.types.size())});
+      } else {
+        action.parameters.emplace_back(
+            ConstantIndex{reader_.read_index(problem_.constants.size())});
+      }
+    }
+    read_conditions(action.preconditions, action.parameters.size());
+    read_ground_atoms(action.ground_preconditions);
+    read_conditions(action.effects, action.parameters.size());
+    read_ground_atoms(action.ground_effects);
+  }
+
+  void read_conditions(std::vector<Condition> &conditions,
+                       size_t num_parameters) {
+    conditions.resize(reader_.read_size());
+    for (auto &condition : conditions) {
+      condition.atom.predicate = read_predicate();
+      auto arity = problem_.predicates[condition.atom.predicate]
+                       .parameter_types.size();
+      if (reader_.read() != arity) {
+        throw InvalidProblemFile{};
+      }
+      condition.atom.arguments.reserve(arity);
+      for (size_t i = 0; i < arity; ++i) {
+        if (reader_.read(1) == 1) {
+          condition.atom.arguments.emplace_back(
+              ParameterIndex{reader_.read_index(num_parameters)});
+        } else {
+          condition.atom.arguments.emplace_back(
+              ConstantIndex{reader_.read_index(problem_.constants.size())});
+        }
+      }
+      condition.positive = reader_.read(1) == 1;
+    }
+  }
+
+  void read_ground_atom(GroundAtom &atom) {
+    atom.predicate = read_predicate();
+    auto arity = problem_.predicates[atom.predicate].parameter_types.size();
+    if (reader_.read() != arity) {
+      throw InvalidProblemFile{};
+    }
+    atom.arguments.resize(arity);
+    for (auto &constant : atom.arguments) {
+      constant = reader_.read_index(problem_.constants.size());
+    }
+  }
+
+  void read_ground_atoms(std::vector<std::pair<GroundAtom, bool>> &atoms) {
+    atoms.resize(reader_.read_size());
+    for (auto &[atom, positive] : atoms) {
+      read_ground_atom(atom);
+      positive = reader_.read(1) == 1;
+    }
+  }
+
+  PredicateIndex read_predicate() {
+    return reader_.read_index(problem_.predicates.size());
+  }
+
+  Reader &reader_;
+  Problem &problem_;
+};
+
+} // namespace
+
+void dump_problem(const Problem &problem, const std::string &file) {
+  Writer writer;
+  writer.write(file_magic);
+  writer.write(problem.domain_name);
+  writer.write(problem.problem_name);
+  writer.write(problem.requirements);
+  writer.write(problem.types.size());
+  for (size_t i = 0; i < problem.types.size(); ++i) {
+    writer.write(problem.types[i].supertype);
+    writer.write(problem.type_names[i]);
+  }
+  writer.write(problem.constants.size());
+  for (size_t i = 0; i < problem.constants.size(); ++i) {
+    writer.write(problem.constants[i].type);
+    writer.write(problem.constant_names[i]);
+  }
+  for (const auto &constants : problem.constants_of_type) {
+    writer.write(constants);
+  }
+  writer.write(problem.predicates.size());
+  for (size_t i = 0; i < problem.predicates.size(); ++i) {
+    writer.write(problem.predicates[i].parameter_types);
+    writer.write(problem.predicate_names[i]);
+  }
+  writer.write(problem.action_names);
+  writer.write(problem.actions.size());
+  for (const auto &action : problem.actions) {
+    writer.write(action.id);
+    writer.write(action.parameters);
+    writer.write(action.preconditions);
+    writer.write(action.ground_preconditions);
+    writer.write(action.effects);
+    writer.write(action.ground_effects);
+  }
+  writer.write(problem.init);
+  writer.write(problem.goal);
+
+  // The file is either replaced completely or not at all
+  const auto &words = writer.get_words();
+  auto tmp_file = file + ".tmp" + std::to_string(::getpid());
+  {
+    std::ofstream out{tmp_file, std::ios::binary};
+    out.write(reinterpret_cast<const char *>(words.data()),
+              static_cast<std::streamsize>(words.size() * sizeof(uint64_t)));
+    if (!out) {
+      std::remove(tmp_file.c_str());
+      throw SerializeException{"Could not write " + file};
+    }
+  }
+  if (std::rename(tmp_file.c_str(), file.c_str()) != 0) {
+    std::remove(tmp_file.c_str());
+    throw SerializeException{"Could not write " + file};
+  }
+}
+
+std::shared_ptr<Problem> load_problem(const std::string &file) {
+  util::MappedFile mapped_file{file};
+  if (!mapped_file.is_open()) {
+    throw SerializeException{"Could not open " + file};
+  }
+  auto problem = std::make_shared<Problem>();
+  try {
+    if (mapped_file.size() % sizeof(uint64_t) != 0) {
+      throw InvalidProblemFile{};
+    }
+    Reader reader{mapped_file};
+    ProblemReader{reader, *problem}.read();
+  } catch (const InvalidProblemFile &) {
+    throw SerializeException{"Invalid normalized problem file " + file};
+  }
+  return problem;
+}
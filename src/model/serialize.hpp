@@ -0,0 +1,46 @@
+#ifndef SERIALIZE_HPP
+#define SERIALIZE_HPP
+
+#include "model/normalized/model.hpp"
+
+#include <exception>
+#include <memory>
+#include <string>
+
+class SerializeException : public std::exception {
+public:
+  explicit SerializeException(std::string message) noexcept
+      : message_{std::move(message)} {}
+
+  inline const char *what() const noexcept override { return message_.c_str(); }
+
+private:
+  std::string message_;
+};
+
+// Binary format of normalized problems, so that large problems can be loaded
+// without parsing and normalizing them again. A file consists of 64 bit
+// words in native byte order:
+//   magic, domain name, problem name, number of requirements, requirements
+//   number of types, for each type: supertype, name
+//   number of constants, for each constant: type, name
+//   for each type: number of constants of the type, constants
+//   number of predicates, for each predicate:
+//     number of parameters, parameter types, name
+//   number of action names, action names
+//   number of actions, for each action:
+//     action id, number of parameters, for each parameter:
+//       free, constant or type
+//     preconditions, ground preconditions, effects, ground effects
+//   init, goal
+// Strings are stored as their length followed by their bytes, padded to full
+// words. Lists are stored as their length followed by their elements. An
+// atom is its predicate followed by its arguments, each preceded by whether
+// it is a parameter if the atom is not ground, and conditions store whether
+// they are positive after the atom.
+void dump_problem(const normalized::Problem &problem, const std::string &file);
+
+// Maps the file and validates all indices
+std::shared_ptr<normalized::Problem> load_problem(const std::string &file);
+
+#endif /* end of include guard: SERIALIZE_HPP */
@@ -2,9 +2,11 @@
 #define AST_HPP
 
 #include "lexer/location.hpp"
+#include "pddl/symbol_table.hpp"
+#include "util/arena.hpp"
+#include "util/input_file.hpp"
 
 #include <memory>
-#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -12,6 +14,15 @@ namespace pddl {
 
 namespace ast {
 
+// Nodes live in the arena of the AST, which frees them all at once. The
+// pointers only express ownership within the tree and never delete.
+struct Release {
+  void operator()(const void *) const noexcept {}
+};
+
+template <typename T> using Ptr = std::unique_ptr<T, Release>;
+template <typename T> using Vector = std::vector<T, util::ArenaAllocator<T>>;
+
 // The basic node for the ast contains only a lexer::Location
 struct Node {
   lexer::Location location;
@@ -22,78 +33,74 @@ protected:
 };
 
 struct Identifier : Node {
-  Identifier(const lexer::Location &location, std::string_view name)
-      : Node{location}, name{name} {}
+  Identifier(const lexer::Location &location, Symbol symbol)
+      : Node{location}, symbol{symbol} {}
 
-  std::string name;
+  Symbol symbol;
 };
 
 struct Variable : Node {
-  Variable(const lexer::Location &location, std::string_view name)
-      : Node{location}, name{name} {}
+  Variable(const lexer::Location &location, Symbol symbol)
+      : Node{location}, symbol{symbol} {}
 
-  std::string name;
+  Symbol symbol;
 };
 
-using Argument =
-    std::variant<std::unique_ptr<Identifier>, std::unique_ptr<Variable>>;
+using Argument = std::variant<Ptr<Identifier>, Ptr<Variable>>;
 
 struct Requirement : Node {
-  Requirement(const lexer::Location &location, std::string_view name)
-      : Node{location}, name{name} {}
+  Requirement(const lexer::Location &location, Symbol symbol)
+      : Node{location}, symbol{symbol} {}
 
-  std::string name;
+  Symbol symbol;
 };
 
 namespace detail {
 
 template <typename T> struct List : Node {
   using value_type = T;
+  using Elements = Vector<value_type>;
 
   List(const lexer::Location &location,
-       std::unique_ptr<std::vector<value_type>> elements)
+       Ptr<Elements> elements)
       : Node{location}, elements{std::move(elements)} {}
 
-  std::unique_ptr<std::vector<value_type>> elements;
+  Ptr<Elements> elements;
 };
 
 template <typename T> struct SingleTypeList : Node {
   using value_type = List<T>;
 
-  SingleTypeList(const lexer::Location &location,
-                 std::unique_ptr<value_type> list,
-                 std::unique_ptr<Identifier> type = nullptr)
+  SingleTypeList(const lexer::Location &location, Ptr<value_type> list,
+                 Ptr<Identifier> type = nullptr)
       : Node{location}, list{std::move(list)}, type{std::move(type)} {}
 
-  std::unique_ptr<value_type> list;
-  std::unique_ptr<Identifier> type;
+  Ptr<value_type> list;
+  Ptr<Identifier> type;
 };
 
 } // namespace detail
 
-using IdentifierList = detail::List<std::unique_ptr<Identifier>>;
-using VariableList = detail::List<std::unique_ptr<Variable>>;
-using RequirementList = detail::List<std::unique_ptr<Requirement>>;
+using IdentifierList = detail::List<Ptr<Identifier>>;
+using VariableList = detail::List<Ptr<Variable>>;
+using RequirementList = detail::List<Ptr<Requirement>>;
 using ArgumentList = detail::List<Argument>;
-using SingleTypeIdentifierList =
-    detail::SingleTypeList<std::unique_ptr<Identifier>>;
-using SingleTypeVariableList =
-    detail::SingleTypeList<std::unique_ptr<Variable>>;
-using TypedIdentifierList =
-    detail::List<std::unique_ptr<SingleTypeIdentifierList>>;
-using TypedVariableList = detail::List<std::unique_ptr<SingleTypeVariableList>>;
+using SingleTypeIdentifierList = detail::SingleTypeList<Ptr<Identifier>>;
+using SingleTypeVariableList = detail::SingleTypeList<Ptr<Variable>>;
+using TypedIdentifierList = detail::List<Ptr<SingleTypeIdentifierList>>;
+using TypedVariableList = detail::List<Ptr<SingleTypeVariableList>>;
 
 struct Predicate : Node {
-  Predicate(const lexer::Location &location, std::unique_ptr<Identifier> name,
-            std::unique_ptr<TypedVariableList> parameters)
+  Predicate(const lexer::Location &location, Ptr<Identifier> name,
+            Ptr<TypedVariableList> parameters)
       : Node{location}, name{std::move(name)}, parameters{
                                                    std::move(parameters)} {}
 
-  std::unique_ptr<Identifier> name;
-  std::unique_ptr<TypedVariableList> parameters;
+  Ptr<Identifier> name;
+  Ptr<TypedVariableList> parameters;
 };
 
-using PredicateList = detail::List<std::unique_ptr<Predicate>>;
+using PredicateList = detail::List<Ptr<Predicate>>;
 
 struct PredicateEvaluation;
 struct Conjunction;
@@ -105,38 +112,34 @@ struct When;
 struct Empty;
 
 using Condition =
-    std::variant<std::unique_ptr<Empty>, std::unique_ptr<PredicateEvaluation>,
-                 std::unique_ptr<Conjunction>, std::unique_ptr<Disjunction>,
-                 std::unique_ptr<Negation>, std::unique_ptr<Imply>,
-                 std::unique_ptr<Quantification>, std::unique_ptr<When>>;
+    std::variant<Ptr<Empty>, Ptr<PredicateEvaluation>, Ptr<Conjunction>,
+                 Ptr<Disjunction>, Ptr<Negation>, Ptr<Imply>,
+                 Ptr<Quantification>, Ptr<When>>;
 
 using ConditionList = detail::List<Condition>;
 
 struct PredicateEvaluation : Node {
-  PredicateEvaluation(const lexer::Location &location,
-                      std::unique_ptr<Identifier> name,
-                      std::unique_ptr<ArgumentList> arguments)
+  PredicateEvaluation(const lexer::Location &location, Ptr<Identifier> name,
+                      Ptr<ArgumentList> arguments)
       : Node{location}, name{std::move(name)}, arguments{std::move(arguments)} {
   }
 
-  std::unique_ptr<Identifier> name;
-  std::unique_ptr<ArgumentList> arguments;
+  Ptr<Identifier> name;
+  Ptr<ArgumentList> arguments;
 };
 
 struct Conjunction : Node {
-  Conjunction(const lexer::Location &location,
-              std::unique_ptr<ConditionList> conditions)
+  Conjunction(const lexer::Location &location, Ptr<ConditionList> conditions)
       : Node{location}, conditions{std::move(conditions)} {}
 
-  std::unique_ptr<ConditionList> conditions;
+  Ptr<ConditionList> conditions;
 };
 
 struct Disjunction : Node {
-  Disjunction(const lexer::Location &location,
-              std::unique_ptr<ConditionList> conditions)
+  Disjunction(const lexer::Location &location, Ptr<ConditionList> conditions)
       : Node{location}, conditions{std::move(conditions)} {}
 
-  std::unique_ptr<ConditionList> conditions;
+  Ptr<ConditionList> conditions;
 };
 
 struct Negation : Node {
@@ -180,65 +183,81 @@ struct Effect : Node {
 
 struct RequirementsDef : Node {
   RequirementsDef(const lexer::Location &location,
-                  std::unique_ptr<RequirementList> requirement_list)
+                  Ptr<RequirementList> requirement_list)
       : Node{location}, requirement_list{std::move(requirement_list)} {}
 
-  std::unique_ptr<RequirementList> requirement_list;
+  Ptr<RequirementList> requirement_list;
 };
 
 struct TypesDef : Node {
-  TypesDef(const lexer::Location &location,
-           std::unique_ptr<TypedIdentifierList> type_list)
+  TypesDef(const lexer::Location &location, Ptr<TypedIdentifierList> type_list)
       : Node{location}, type_list{std::move(type_list)} {}
 
-  std::unique_ptr<TypedIdentifierList> type_list;
+  Ptr<TypedIdentifierList> type_list;
 };
 
 struct ConstantsDef : Node {
   ConstantsDef(const lexer::Location &location,
-               std::unique_ptr<TypedIdentifierList> constant_list)
+               Ptr<TypedIdentifierList> constant_list)
       : Node{location}, constant_list{std::move(constant_list)} {}
 
-  std::unique_ptr<TypedIdentifierList> constant_list;
+  Ptr<TypedIdentifierList> constant_list;
 };
 
 struct PredicatesDef : Node {
   PredicatesDef(const lexer::Location &location,
-                std::unique_ptr<PredicateList> predicate_list)
+                Ptr<PredicateList> predicate_list)
       : Node{location}, predicate_list{std::move(predicate_list)} {}
 
-  std::unique_ptr<PredicateList> predicate_list;
+  Ptr<PredicateList> predicate_list;
 };
 
 struct ActionDef : Node {
-  ActionDef(const lexer::Location &location, std::unique_ptr<Identifier> name,
-            std::unique_ptr<TypedVariableList> parameters,
-            std::unique_ptr<Precondition> precondition = nullptr,
-            std::unique_ptr<Effect> effect = nullptr)
+  ActionDef(const lexer::Location &location, Ptr<Identifier> name,
+            Ptr<TypedVariableList> parameters,
+            Ptr<Precondition> precondition = nullptr,
+            Ptr<Effect> effect = nullptr)
       : Node{location}, name{std::move(name)}, parameters{std::move(
                                                    parameters)},
         precondition{std::move(precondition)}, effect{std::move(effect)} {}
 
-  std::unique_ptr<Identifier> name;
-  std::unique_ptr<TypedVariableList> parameters;
-  std::unique_ptr<Precondition> precondition;
-  std::unique_ptr<Effect> effect;
+  Ptr<Identifier> name;
+  Ptr<TypedVariableList> parameters;
+  Ptr<Precondition> precondition;
+  Ptr<Effect> effect;
 };
 
 struct ObjectsDef : Node {
-  ObjectsDef(const lexer::Location &location,
-             std::unique_ptr<TypedIdentifierList> objects)
+  ObjectsDef(const lexer::Location &location, Ptr<TypedIdentifierList> objects)
       : Node{location}, objects{std::move(objects)} {}
 
-  std::unique_ptr<TypedIdentifierList> objects;
+  Ptr<TypedIdentifierList> objects;
+};
+
+// Ground atom of the init section. The init section makes up most of a large
+// problem, so its atoms are stored flat instead of as nodes.
+struct Fact {
+  lexer::Location get_arguments_location() const {
+    return lexer::Location{arguments_begin, location.end()};
+  }
+
+  lexer::Location location;
+  lexer::Position arguments_begin;
+  Symbol predicate;
+  bool positive;
+  // Range of the arguments in InitDef::arguments
+  size_t first_argument;
+  size_t num_arguments;
 };
 
 struct InitDef : Node {
-  InitDef(const lexer::Location &location,
-          std::unique_ptr<ConditionList> init_list)
-      : Node{location}, init_list{std::move(init_list)} {}
+  InitDef(const lexer::Location &location, Ptr<Vector<Fact>> facts,
+          Ptr<Vector<Symbol>> arguments)
+      : Node{location}, facts{std::move(facts)}, arguments{
+                                                     std::move(arguments)} {}
 
-  std::unique_ptr<ConditionList> init_list;
+  Ptr<Vector<Fact>> facts;
+  Ptr<Vector<Symbol>> arguments;
 };
 
 struct GoalDef : Node {
@@ -257,57 +276,64 @@ struct MetricDef : Node {
 };
 
 using Element =
-    std::variant<std::unique_ptr<RequirementsDef>, std::unique_ptr<TypesDef>,
-                 std::unique_ptr<ConstantsDef>, std::unique_ptr<PredicatesDef>,
-                 std::unique_ptr<ActionDef>, std::unique_ptr<ObjectsDef>,
-                 std::unique_ptr<InitDef>, std::unique_ptr<GoalDef>,
-                 std::unique_ptr<FunctionsDef>, std::unique_ptr<MetricDef>>;
+    std::variant<Ptr<RequirementsDef>, Ptr<TypesDef>, Ptr<ConstantsDef>,
+                 Ptr<PredicatesDef>, Ptr<ActionDef>, Ptr<ObjectsDef>,
+                 Ptr<InitDef>, Ptr<GoalDef>, Ptr<FunctionsDef>,
+                 Ptr<MetricDef>>;
 using ElementList = detail::List<Element>;
 
 struct Domain : Node {
-  Domain(const lexer::Location &location, std::unique_ptr<Identifier> name,
-         std::unique_ptr<ElementList> domain_body)
+  Domain(const lexer::Location &location, Ptr<Identifier> name,
+         Ptr<ElementList> domain_body)
       : Node{location}, name{std::move(name)}, domain_body{
                                                    std::move(domain_body)} {}
 
-  std::unique_ptr<Identifier> name;
-  std::unique_ptr<ElementList> domain_body;
+  Ptr<Identifier> name;
+  Ptr<ElementList> domain_body;
 };
 
 struct Problem : Node {
-  Problem(const lexer::Location &location, std::unique_ptr<Identifier> name,
-          std::unique_ptr<Identifier> domain_ref,
-          std::unique_ptr<ElementList> problem_body)
+  Problem(const lexer::Location &location, Ptr<Identifier> name,
+          Ptr<Identifier> domain_ref, Ptr<ElementList> problem_body)
       : Node{location}, name{std::move(name)},
         domain_ref{std::move(domain_ref)}, problem_body{
                                                std::move(problem_body)} {}
 
-  std::unique_ptr<Identifier> name;
-  std::unique_ptr<Identifier> domain_ref;
-  std::unique_ptr<ElementList> problem_body;
+  Ptr<Identifier> name;
+  Ptr<Identifier> domain_ref;
+  Ptr<ElementList> problem_body;
 };
 
 /* The AST is built while parsing. It abstracts the entire input and can later
- * be traversed by a visitor. Most constructors only take unique pointers so
- * that the AST must be built inplace */
+ * be traversed by a visitor. Most constructors only take owning pointers so
+ * that the AST must be built inplace. All nodes are allocated in the arena of
+ * the AST and freed with it. Names are interned as symbols whose names are
+ * views into the input files, which are owned by the AST. */
 class AST {
 public:
   AST() {}
 
-  void set_domain(std::unique_ptr<Domain> domain) {
-    domain_ = std::move(domain);
-  }
+  void set_domain(Ptr<Domain> domain) { domain_ = std::move(domain); }
+
+  void set_problem(Ptr<Problem> problem) { problem_ = std::move(problem); }
 
-  void set_problem(std::unique_ptr<Problem> problem) {
-    problem_ = std::move(problem);
+  void add_input(std::unique_ptr<util::InputFile> input) {
+    inputs_.push_back(std::move(input));
   }
 
+  util::Arena &get_arena() { return *arena_; }
+  SymbolTable &get_symbols() { return symbols_; }
+  const SymbolTable &get_symbols() const { return symbols_; }
   const Domain *get_domain() const { return domain_.get(); }
   const Problem *get_problem() const { return problem_.get(); }
 
 private:
-  std::unique_ptr<Domain> domain_;
-  std::unique_ptr<Problem> problem_;
+  std::vector<std::unique_ptr<util::InputFile>> inputs_;
+  SymbolTable symbols_;
+  // Stays in place when the AST is moved
+  std::unique_ptr<util::Arena> arena_ = std::make_unique<util::Arena>();
+  Ptr<Domain> domain_;
+  Ptr<Problem> problem_;
 };
 
 } // namespace ast
@@ -106,13 +106,6 @@ public:
            get_derived_().visit_end(objects_def);
   }
 
-  bool traverse(const InitDef &init_def) {
-    current_location_ = &init_def.location;
-    return get_derived_().visit_begin(init_def) &&
-           get_derived_().traverse(*init_def.init_list) &&
-           get_derived_().visit_end(init_def);
-  }
-
   bool traverse(const GoalDef &goal_def) {
     current_location_ = &goal_def.location;
     return get_derived_().visit_begin(goal_def) &&
@@ -232,8 +225,8 @@ private:
     return derived;
   }
 
-  template <typename T>
-  bool traverse_vector(const std::vector<std::unique_ptr<T>> &element) {
+  template <typename T, typename Allocator>
+  bool traverse_vector(const std::vector<Ptr<T>, Allocator> &element) {
     for (const auto &c : element) {
       if (!get_derived_().traverse(*c)) {
         return false;
@@ -242,7 +235,8 @@ private:
     return true;
   }
 
-  template <typename T> bool traverse_vector(const std::vector<T> &element) {
+  template <typename T, typename Allocator>
+  bool traverse_vector(const std::vector<T, Allocator> &element) {
     for (const auto &c : element) {
       if (!get_derived_().traverse(c)) {
         return false;
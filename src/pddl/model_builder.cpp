@@ -19,6 +19,11 @@ void ModelBuilder::reset() {
   current_predicate_ = parsed::PredicateHandle{};
   current_action_ = parsed::ActionHandle{};
   condition_stack_.clear();
+  symbols_ = nullptr;
+  types_.clear();
+  constants_.clear();
+  predicates_.clear();
+  parameters_.clear();
   problem_.reset();
 }
 
@@ -27,6 +32,11 @@ std::unique_ptr<parsed::Problem> ModelBuilder::parse(const ast::AST &ast) {
 
   reset();
 
+  symbols_ = &ast.get_symbols();
+  types_.resize(symbols_->size());
+  constants_.resize(symbols_->size());
+  predicates_.resize(symbols_->size());
+  parameters_.resize(symbols_->size());
   problem_ = std::make_unique<parsed::Problem>();
   root_type_ = problem_->add_type("_root");
   auto equal_predicate = problem_->add_predicate("=");
@@ -43,24 +53,61 @@ std::unique_ptr<parsed::Problem> ModelBuilder::parse(const ast::AST &ast) {
   return std::move(problem_);
 }
 
+std::string ModelBuilder::get_name(Symbol symbol) const {
+  return std::string{symbols_->get_name(symbol)};
+}
+
+parsed::TypeHandle ModelBuilder::get_type(Symbol symbol) {
+  if (types_[symbol] == parsed::TypeHandle{}) {
+    types_[symbol] = problem_->get_type(symbols_->get_name(symbol));
+  }
+  return types_[symbol];
+}
+
+parsed::ConstantHandle ModelBuilder::get_constant(Symbol symbol) {
+  if (constants_[symbol] == parsed::ConstantHandle{}) {
+    constants_[symbol] = problem_->get_constant(symbols_->get_name(symbol));
+  }
+  return constants_[symbol];
+}
+
+parsed::PredicateHandle ModelBuilder::get_predicate(Symbol symbol) {
+  if (predicates_[symbol] == parsed::PredicateHandle{}) {
+    predicates_[symbol] = problem_->get_predicate(symbols_->get_name(symbol));
+  }
+  return predicates_[symbol];
+}
+
+parsed::ParameterHandle ModelBuilder::get_parameter(Symbol symbol) {
+  // Parameter handles of previous actions are stale
+  if (parameters_[symbol].get_base() != current_action_.get()) {
+    parameters_[symbol] =
+        current_action_->get_parameter(symbols_->get_name(symbol));
+  }
+  return parameters_[symbol];
+}
+
 bool ModelBuilder::visit_begin(const ast::Domain &domain) {
-  LOG_DEBUG(parser_logger, "Visiting domain '%s'", domain.name->name.c_str());
-  problem_->set_domain_name(domain.name->name);
+  LOG_DEBUG(parser_logger, "Visiting domain '%s'",
+            get_name(domain.name->symbol).c_str());
+  problem_->set_domain_name(get_name(domain.name->symbol));
   return true;
 }
 
 bool ModelBuilder::visit_begin(const ast::Problem &problem) {
   LOG_DEBUG(parser_logger, "Visiting problem '%s' with domain reference '%s'",
-            problem.name->name.c_str(), problem.domain_ref->name.c_str());
-  problem_->set_problem_name(problem.name->name, problem.domain_ref->name);
+            get_name(problem.name->symbol).c_str(),
+            get_name(problem.domain_ref->symbol).c_str());
+  problem_->set_problem_name(get_name(problem.name->symbol),
+                             get_name(problem.domain_ref->symbol));
   return true;
 }
 
 bool ModelBuilder::visit_begin(const ast::SingleTypeIdentifierList &list) {
   LOG_DEBUG(parser_logger, "Visiting identifier list of type '%s'",
-            list.type ? list.type->name.c_str() : "_root");
+            list.type ? get_name(list.type->symbol).c_str() : "_root");
   if (list.type) {
-    current_type_ = problem_->get_type(list.type->name);
+    current_type_ = get_type(list.type->symbol);
   } else {
     current_type_ = root_type_;
   }
@@ -74,9 +121,9 @@ bool ModelBuilder::visit_end(const ast::SingleTypeIdentifierList &) {
 
 bool ModelBuilder::visit_begin(const ast::SingleTypeVariableList &list) {
   LOG_DEBUG(parser_logger, "Visiting variable list of type '%s'",
-            list.type ? list.type->name.c_str() : "_root");
+            list.type ? get_name(list.type->symbol).c_str() : "_root");
   if (list.type) {
-    current_type_ = problem_->get_type(list.type->name);
+    current_type_ = get_type(list.type->symbol);
   } else {
     current_type_ = root_type_;
   }
@@ -93,13 +140,15 @@ bool ModelBuilder::visit_begin(const ast::IdentifierList &list) {
   case State::Types:
     LOG_DEBUG(parser_logger, "Visiting identifier list as types");
     for (const auto &name : *list.elements) {
-      problem_->add_type(name->name, current_type_);
+      types_[name->symbol] =
+          problem_->add_type(get_name(name->symbol), current_type_);
     }
     break;
   case State::Constants:
     LOG_DEBUG(parser_logger, "Visiting identifier list as constants");
     for (const auto &name : *list.elements) {
-      problem_->add_constant(name->name, current_type_);
+      constants_[name->symbol] =
+          problem_->add_constant(get_name(name->symbol), current_type_);
     }
     break;
   default:
@@ -118,7 +167,8 @@ bool ModelBuilder::visit_begin(const ast::VariableList &list) {
     if (state_ == State::Predicates) {
       problem_->add_parameter_type(current_predicate_, current_type_);
     } else {
-      problem_->add_parameter(current_action_, variable->name, current_type_);
+      parameters_[variable->symbol] = problem_->add_parameter(
+          current_action_, get_name(variable->symbol), current_type_);
     }
   }
   return true;
@@ -137,17 +187,15 @@ bool ModelBuilder::visit_begin(const ast::ArgumentList &list) {
   for (size_t i = 0; i < list.elements->size(); ++i) {
     const auto &argument = (*list.elements)[i];
     if (auto identifier =
-            std::get_if<std::unique_ptr<ast::Identifier>>(&argument)) {
-      predicate->add_constant_argument(
-          problem_->get_constant((*identifier)->name));
+            std::get_if<ast::Ptr<ast::Identifier>>(&argument)) {
+      predicate->add_constant_argument(get_constant((*identifier)->symbol));
     } else if (auto variable =
-                   std::get_if<std::unique_ptr<ast::Variable>>(&argument)) {
+                   std::get_if<ast::Ptr<ast::Variable>>(&argument)) {
       if (state_ != State::Precondition && state_ != State::Effect) {
         throw parsed::ModelException{
             "Bound arguments are only allowed within actions"};
       }
-      predicate->add_bound_argument(
-          current_action_->get_parameter((*variable)->name));
+      predicate->add_bound_argument(get_parameter((*variable)->symbol));
     } else {
       throw ParserException("Internal error occurred while parsing");
     }
@@ -182,7 +230,7 @@ bool ModelBuilder::visit_begin(const ast::PredicatesDef &) {
 bool ModelBuilder::visit_begin(const ast::ActionDef &action_def) {
   LOG_DEBUG(parser_logger, "Visiting action definition");
   state_ = State::Action;
-  current_action_ = problem_->add_action(action_def.name->name);
+  current_action_ = problem_->add_action(get_name(action_def.name->symbol));
   return true;
 }
 
@@ -197,9 +245,22 @@ bool ModelBuilder::visit_begin(const ast::ObjectsDef &) {
   return true;
 }
 
-bool ModelBuilder::visit_begin(const ast::InitDef &) {
+bool ModelBuilder::visit_begin(const ast::InitDef &init_def) {
   LOG_DEBUG(parser_logger, "Visiting init definition");
   state_ = State::Init;
+  current_location_ = &fact_location_;
+  for (const auto &fact : *init_def.facts) {
+    fact_location_ = fact.location;
+    auto init = std::make_shared<parsed::FreePredicate>(
+        fact.positive, get_predicate(fact.predicate));
+    fact_location_ = fact.get_arguments_location();
+    for (size_t i = 0; i < fact.num_arguments; ++i) {
+      init->add_constant_argument(
+          get_constant((*init_def.arguments)[fact.first_argument + i]));
+    }
+    fact_location_ = fact.location;
+    problem_->add_init(std::move(init));
+  }
   return true;
 }
 
@@ -234,7 +295,9 @@ bool ModelBuilder::visit_end(const ast::Negation &) {
 }
 
 bool ModelBuilder::visit_begin(const ast::Predicate &predicate) {
-  current_predicate_ = problem_->add_predicate(predicate.name->name);
+  current_predicate_ =
+      problem_->add_predicate(get_name(predicate.name->symbol));
+  predicates_[predicate.name->symbol] = current_predicate_;
   return true;
 }
 
@@ -244,7 +307,7 @@ bool ModelBuilder::visit_end(const ast::Predicate &) {
 }
 
 bool ModelBuilder::visit_begin(const ast::PredicateEvaluation &predicate) {
-  auto definition = problem_->get_predicate(predicate.name->name);
+  auto definition = get_predicate(predicate.name->symbol);
   switch (state_) {
   case State::Precondition:
     condition_stack_.push_back(std::make_shared<parsed::AtomicCondition<
@@ -257,7 +320,6 @@ bool ModelBuilder::visit_begin(const ast::PredicateEvaluation &predicate) {
             parsed::AtomicCondition<parsed::ConditionContextType::Effect>>(
             positive_, definition, current_action_));
     break;
-  case State::Init: // Fallthrough
   case State::Goal:
     condition_stack_.push_back(
         std::make_shared<parsed::FreePredicate>(positive_, definition));
@@ -282,7 +344,6 @@ bool ModelBuilder::visit_begin(const ast::Conjunction &) {
             parsed::Junction<parsed::ConditionContextType::Effect>>(
             parsed::JunctionOperator::And, positive_, current_action_));
     break;
-  case State::Init: // Fallthrough
   case State::Goal:
     condition_stack_.push_back(
         std::make_shared<parsed::Junction<parsed::ConditionContextType::Free>>(
@@ -308,7 +369,6 @@ bool ModelBuilder::visit_begin(const ast::Disjunction &) {
             parsed::Junction<parsed::ConditionContextType::Effect>>(
             parsed::JunctionOperator::Or, positive_, current_action_));
     break;
-  case State::Init: // Fallthrough
   case State::Goal:
     condition_stack_.push_back(
         std::make_shared<parsed::Junction<parsed::ConditionContextType::Free>>(
@@ -321,8 +381,8 @@ bool ModelBuilder::visit_begin(const ast::Disjunction &) {
 }
 
 bool ModelBuilder::visit_end(const ast::Condition &condition) {
-  if (std::holds_alternative<std::unique_ptr<ast::Empty>>(condition) ||
-      std::holds_alternative<std::unique_ptr<ast::Negation>>(condition)) {
+  if (std::holds_alternative<ast::Ptr<ast::Empty>>(condition) ||
+      std::holds_alternative<ast::Ptr<ast::Negation>>(condition)) {
     return true;
   }
   auto last_condition = condition_stack_.back();
@@ -352,14 +412,6 @@ bool ModelBuilder::visit_end(const ast::Condition &condition) {
         throw ParserException("Internal error occurred while parsing");
       }
       break;
-    case State::Init:
-      if (auto p = std::dynamic_pointer_cast<parsed::FreePredicate>(
-              last_condition)) {
-        problem_->add_init(p);
-      } else {
-        throw ParserException("Internal error occurred while parsing");
-      }
-      break;
     default:
       throw ParserException("Internal error occurred while parsing");
     }
@@ -376,8 +428,8 @@ bool ModelBuilder::visit_end(const ast::Condition &condition) {
 
 bool ModelBuilder::visit_begin(const ast::Requirement &requirement) {
   LOG_DEBUG(parser_logger, "Visiting requirement '%s'",
-            requirement.name.c_str());
-  problem_->add_requirement(requirement.name);
+            get_name(requirement.symbol).c_str());
+  problem_->add_requirement(get_name(requirement.symbol));
   return true;
 }
 
@@ -1,10 +1,12 @@
 #ifndef MODEL_BUILDER_HPP
 #define MODEL_BUILDER_HPP
 
+#include "lexer/location.hpp"
 #include "logging/logging.hpp"
 #include "model/parsed/model.hpp"
 #include "pddl/ast/ast.hpp"
 #include "pddl/ast/visitor.hpp"
+#include "pddl/symbol_table.hpp"
 
 #include <algorithm>
 #include <memory>
@@ -40,6 +42,11 @@ private:
   using Visitor<ModelBuilder>::visit_end;
 
   void reset();
+  std::string get_name(Symbol symbol) const;
+  parsed::TypeHandle get_type(Symbol symbol);
+  parsed::ConstantHandle get_constant(Symbol symbol);
+  parsed::PredicateHandle get_predicate(Symbol symbol);
+  parsed::ParameterHandle get_parameter(Symbol symbol);
   bool visit_begin(const ast::Domain &domain);
   bool visit_begin(const ast::Problem &problem);
   bool visit_begin(const ast::SingleTypeIdentifierList &list);
@@ -56,7 +63,7 @@ private:
   bool visit_begin(const ast::ActionDef &action_def);
   bool visit_end(const ast::ActionDef &);
   bool visit_begin(const ast::ObjectsDef &);
-  bool visit_begin(const ast::InitDef &);
+  bool visit_begin(const ast::InitDef &init_def);
   bool visit_begin(const ast::GoalDef &);
   bool visit_begin(const ast::Effect &);
   bool visit_begin(const ast::Precondition &);
@@ -77,6 +84,14 @@ private:
   parsed::PredicateHandle current_predicate_ = parsed::PredicateHandle{};
   parsed::ActionHandle current_action_ = parsed::ActionHandle{};
   std::vector<std::shared_ptr<parsed::Condition>> condition_stack_;
+  // Facts have no nodes whose locations could be referred to
+  lexer::Location fact_location_;
+  const SymbolTable *symbols_ = nullptr;
+  // Handles by symbol, set on definition or on the first lookup by name
+  std::vector<parsed::TypeHandle> types_;
+  std::vector<parsed::ConstantHandle> constants_;
+  std::vector<parsed::PredicateHandle> predicates_;
+  std::vector<parsed::ParameterHandle> parameters_;
   size_t num_requirements_ = 0;
   size_t num_types_ = 0;
   size_t num_constants_ = 0;
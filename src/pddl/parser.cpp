@@ -3,9 +3,8 @@
 #include "pddl/ast/ast.hpp"
 #include "pddl/parser_exception.hpp"
 #include "pddl/tokens.hpp"
+#include "util/input_file.hpp"
 
-#include <fstream>
-#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,24 +13,25 @@ namespace pddl {
 
 ast::AST Parser::parse(const std::string &domain, const std::string &problem) {
   ast::AST ast;
-  std::ifstream domain_in{domain};
-  std::string domain_bytes{std::istreambuf_iterator<char>{domain_in},
-                           std::istreambuf_iterator<char>{}};
-  std::ifstream problem_in{problem};
-  std::string problem_bytes{std::istreambuf_iterator<char>{problem_in},
-                            std::istreambuf_iterator<char>{}};
-  if (!domain_in.is_open()) {
+  symbols_ = &ast.get_symbols();
+  arena_ = &ast.get_arena();
+  lexer_.set_action(TokenAction{symbols_});
+  auto domain_in = std::make_unique<util::InputFile>(domain);
+  auto problem_in = std::make_unique<util::InputFile>(problem);
+  if (!domain_in->is_open()) {
     throw ParserException{"Failed to open " + domain};
   }
-  if (!problem_in.is_open()) {
+  if (!problem_in->is_open()) {
     throw ParserException{"Failed to open " + problem};
   }
-  lexer_.set_source(domain, domain_bytes.data(),
-                    domain_bytes.data() + domain_bytes.size());
+  lexer_.set_source(domain, domain_in->data(),
+                    domain_in->data() + domain_in->size());
+  ast.add_input(std::move(domain_in));
   LOG_INFO(parser_logger, "Parsing domain file...");
   parse_domain(ast);
-  lexer_.set_source(problem, problem_bytes.data(),
-                    problem_bytes.data() + problem_bytes.size());
+  lexer_.set_source(problem, problem_in->data(),
+                    problem_in->data() + problem_in->size());
+  ast.add_input(std::move(problem_in));
   LOG_INFO(parser_logger, "Parsing problem file...");
   parse_problem(ast);
   return ast;
@@ -48,112 +48,115 @@ void Parser::advance() {
   skip_comments();
 }
 
-std::unique_ptr<ast::IdentifierList> Parser::parse_identifier_list() {
+ast::Ptr<ast::IdentifierList> Parser::parse_identifier_list() {
   LOG_DEBUG(parser_logger, "Parsing identifier list");
   const auto begin = lexer_.location();
-  auto names =
-      std::make_unique<std::vector<std::unique_ptr<ast::Identifier>>>();
+  auto names = make_elements<ast::IdentifierList>();
   while (lexer_.has_type<token::Name>()) {
-    const auto &name = lexer_.get<token::Name>().name;
-    LOG_DEBUG(parser_logger, "Found identifier \'%s\'", std::string{name}.c_str());
-    auto identifier =
-        std::make_unique<ast::Identifier>(lexer_.location(), name);
+    const auto symbol = lexer_.get<token::Name>().symbol;
+    LOG_DEBUG(parser_logger, "Found identifier \'%s\'",
+              std::string{symbols_->get_name(symbol)}.c_str());
+    auto identifier = make<ast::Identifier>(lexer_.location(), symbol);
     names->push_back(std::move(identifier));
     lexer_.next();
   }
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of identifier list (%u element(s))", names->size());
-  return std::make_unique<ast::IdentifierList>(begin + end, std::move(names));
+  return make<ast::IdentifierList>(begin + end, std::move(names));
 }
 
-std::unique_ptr<ast::VariableList> Parser::parse_variable_list() {
+ast::Ptr<ast::VariableList> Parser::parse_variable_list() {
   LOG_DEBUG(parser_logger, "Parsing variable list");
   const auto begin = lexer_.location();
-  auto names = std::make_unique<std::vector<std::unique_ptr<ast::Variable>>>();
+  auto names = make_elements<ast::VariableList>();
   while (lexer_.has_type<token::Variable>()) {
-    const auto &name = lexer_.get<token::Variable>().name;
-    LOG_DEBUG(parser_logger, "Found variable \'%s\'", std::string{name}.c_str());
-    auto variable = std::make_unique<ast::Variable>(lexer_.location(), name);
+    const auto symbol = lexer_.get<token::Variable>().symbol;
+    LOG_DEBUG(parser_logger, "Found variable \'%s\'",
+              std::string{symbols_->get_name(symbol)}.c_str());
+    auto variable = make<ast::Variable>(lexer_.location(), symbol);
     names->push_back(std::move(variable));
     lexer_.next();
   }
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of variable list (%u element(s))", names->size());
-  return std::make_unique<ast::VariableList>(begin + end, std::move(names));
+  return make<ast::VariableList>(begin + end, std::move(names));
 }
 
-std::unique_ptr<ast::ArgumentList> Parser::parse_argument_list() {
+ast::Ptr<ast::ArgumentList> Parser::parse_argument_list() {
   LOG_DEBUG(parser_logger, "Parsing argument list");
   const auto begin = lexer_.location();
-  auto arguments = std::make_unique<std::vector<ast::Argument>>();
+  auto arguments = make_elements<ast::ArgumentList>();
   while (lexer_.has_type<token::Name>() || lexer_.has_type<token::Variable>()) {
     if (lexer_.has_type<token::Name>()) {
-      const auto &name = lexer_.get<token::Name>().name;
-      LOG_DEBUG(parser_logger, "Found identifier \'%s\'", std::string{name}.c_str());
-      auto argument =
-          std::make_unique<ast::Identifier>(lexer_.location(), name);
+      const auto symbol = lexer_.get<token::Name>().symbol;
+      LOG_DEBUG(parser_logger, "Found identifier \'%s\'",
+                std::string{symbols_->get_name(symbol)}.c_str());
+      auto argument = make<ast::Identifier>(lexer_.location(), symbol);
       arguments->push_back(std::move(argument));
     } else {
-      const auto &name = lexer_.get<token::Variable>().name;
-      LOG_DEBUG(parser_logger, "Found variable \'%s\'", std::string{name}.c_str());
-      auto argument = std::make_unique<ast::Variable>(lexer_.location(), name);
+      const auto symbol = lexer_.get<token::Variable>().symbol;
+      LOG_DEBUG(parser_logger, "Found variable \'%s\'",
+                std::string{symbols_->get_name(symbol)}.c_str());
+      auto argument = make<ast::Variable>(lexer_.location(), symbol);
       arguments->push_back(std::move(argument));
     }
     lexer_.next();
   }
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of argument list (%u element(s))", arguments->size());
-  return std::make_unique<ast::ArgumentList>(begin + end, std::move(arguments));
+  return make<ast::ArgumentList>(begin + end, std::move(arguments));
 }
 
-std::unique_ptr<ast::SingleTypeIdentifierList>
+ast::Ptr<ast::SingleTypeIdentifierList>
 Parser::parse_single_type_identifier_list() {
   LOG_DEBUG(parser_logger, "Parsing single type identifier list");
   const auto begin = lexer_.location();
   auto name_list = parse_identifier_list();
   if (skip_if<token::Hyphen>()) {
-    const auto &name = lexer_.get<token::Name>().name;
-    LOG_DEBUG(parser_logger, "Found type \'%s\'", std::string{name}.c_str());
-    auto type = std::make_unique<ast::Identifier>(lexer_.location(), name);
+    const auto symbol = lexer_.get<token::Name>().symbol;
+    LOG_DEBUG(parser_logger, "Found type \'%s\'",
+              std::string{symbols_->get_name(symbol)}.c_str());
+    auto type = make<ast::Identifier>(lexer_.location(), symbol);
     lexer_.next();
     const auto &end = type->location;
     LOG_DEBUG(parser_logger, "End of single type identifier list");
-    return std::make_unique<ast::SingleTypeIdentifierList>(
-        begin + end, std::move(name_list), std::move(type));
+    return make<ast::SingleTypeIdentifierList>(begin + end,
+                                               std::move(name_list),
+                                               std::move(type));
   } else {
     LOG_DEBUG(parser_logger, "End of single type identifier list");
-    return std::make_unique<ast::SingleTypeIdentifierList>(
-        name_list->location, std::move(name_list));
+    return make<ast::SingleTypeIdentifierList>(name_list->location,
+                                               std::move(name_list));
   }
 }
 
-std::unique_ptr<ast::SingleTypeVariableList>
+ast::Ptr<ast::SingleTypeVariableList>
 Parser::parse_single_type_variable_list() {
   LOG_DEBUG(parser_logger, "Parsing single type variable list");
   const auto begin = lexer_.location();
   auto variable_list = parse_variable_list();
   if (skip_if<token::Hyphen>()) {
-    const auto &name = lexer_.get<token::Name>().name;
-    LOG_DEBUG(parser_logger, "Found type \'%s\'", std::string{name}.c_str());
-    auto type = std::make_unique<ast::Identifier>(lexer_.location(), name);
+    const auto symbol = lexer_.get<token::Name>().symbol;
+    LOG_DEBUG(parser_logger, "Found type \'%s\'",
+              std::string{symbols_->get_name(symbol)}.c_str());
+    auto type = make<ast::Identifier>(lexer_.location(), symbol);
     lexer_.next();
     const auto &end = type->location;
     LOG_DEBUG(parser_logger, "End of single type variable list");
-    return std::make_unique<ast::SingleTypeVariableList>(
-        begin + end, std::move(variable_list), std::move(type));
+    return make<ast::SingleTypeVariableList>(begin + end,
+                                             std::move(variable_list),
+                                             std::move(type));
   } else {
     LOG_DEBUG(parser_logger, "End of single type variable list");
-    return std::make_unique<ast::SingleTypeVariableList>(
-        variable_list->location, std::move(variable_list));
+    return make<ast::SingleTypeVariableList>(variable_list->location,
+                                             std::move(variable_list));
   }
 }
 
-std::unique_ptr<ast::TypedIdentifierList>
-Parser::parse_typed_identifier_list() {
+ast::Ptr<ast::TypedIdentifierList> Parser::parse_typed_identifier_list() {
   LOG_DEBUG(parser_logger, "Parsing typed identifier list");
   const auto begin = lexer_.location();
-  auto lists = std::make_unique<
-      std::vector<std::unique_ptr<ast::SingleTypeIdentifierList>>>();
+  auto lists = make_elements<ast::TypedIdentifierList>();
   while (lexer_.has_type<token::Name>()) {
     auto single_list = parse_single_type_identifier_list();
     lists->push_back(std::move(single_list));
@@ -162,15 +165,13 @@ Parser::parse_typed_identifier_list() {
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of typed identifier list (%u single type lists)",
             lists->size());
-  return std::make_unique<ast::TypedIdentifierList>(begin + end,
-                                                    std::move(lists));
+  return make<ast::TypedIdentifierList>(begin + end, std::move(lists));
 }
 
-std::unique_ptr<ast::TypedVariableList> Parser::parse_typed_variable_list() {
+ast::Ptr<ast::TypedVariableList> Parser::parse_typed_variable_list() {
   LOG_DEBUG(parser_logger, "Parsing typed variable list");
   const auto begin = lexer_.location();
-  auto lists = std::make_unique<
-      std::vector<std::unique_ptr<ast::SingleTypeVariableList>>>();
+  auto lists = make_elements<ast::TypedVariableList>();
   while (lexer_.has_type<token::Variable>()) {
     auto single_list = parse_single_type_variable_list();
     lists->push_back(std::move(single_list));
@@ -179,81 +180,76 @@ std::unique_ptr<ast::TypedVariableList> Parser::parse_typed_variable_list() {
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of typed variable list (%u single type lists)",
             lists->size());
-  return std::make_unique<ast::TypedVariableList>(begin + end,
-                                                  std::move(lists));
+  return make<ast::TypedVariableList>(begin + end, std::move(lists));
 }
 
-std::unique_ptr<ast::RequirementList> Parser::parse_requirement_list() {
+ast::Ptr<ast::RequirementList> Parser::parse_requirement_list() {
   LOG_DEBUG(parser_logger, "Parsing requirements list");
   const auto begin = lexer_.location();
-  auto requirements =
-      std::make_unique<std::vector<std::unique_ptr<ast::Requirement>>>();
+  auto requirements = make_elements<ast::RequirementList>();
   while (lexer_.has_type<token::Requirement>()) {
-    const auto &name = lexer_.get<token::Requirement>().name;
-    LOG_DEBUG(parser_logger, "Found requirement \'%s\'", std::string{name}.c_str());
-    auto requirement =
-        std::make_unique<ast::Requirement>(lexer_.location(), name);
+    const auto symbol = lexer_.get<token::Requirement>().symbol;
+    LOG_DEBUG(parser_logger, "Found requirement \'%s\'",
+              std::string{symbols_->get_name(symbol)}.c_str());
+    auto requirement = make<ast::Requirement>(lexer_.location(), symbol);
     requirements->push_back(std::move(requirement));
     lexer_.next();
   }
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of requirements list (%u element(s))",
             requirements->size());
-  return std::make_unique<ast::RequirementList>(begin + end,
-                                                std::move(requirements));
+  return make<ast::RequirementList>(begin + end, std::move(requirements));
 }
 
-std::unique_ptr<ast::RequirementsDef> Parser::parse_requirements() {
+ast::Ptr<ast::RequirementsDef> Parser::parse_requirements() {
   LOG_DEBUG(parser_logger, "Parsing requirements definition");
   const auto begin = lexer_.location();
   advance();
   auto requirement_list = parse_requirement_list();
   const auto &end = requirement_list->location;
   LOG_DEBUG(parser_logger, "End of requirements definition");
-  return std::make_unique<ast::RequirementsDef>(begin + end,
-                                                std::move(requirement_list));
+  return make<ast::RequirementsDef>(begin + end, std::move(requirement_list));
 }
 
-std::unique_ptr<ast::TypesDef> Parser::parse_types() {
+ast::Ptr<ast::TypesDef> Parser::parse_types() {
   LOG_DEBUG(parser_logger, "Parsing types definition");
   const auto begin = lexer_.location();
   advance();
   auto type_list = parse_typed_identifier_list();
   const auto &end = type_list->location;
   LOG_DEBUG(parser_logger, "End of types definition");
-  return std::make_unique<ast::TypesDef>(begin + end, std::move(type_list));
+  return make<ast::TypesDef>(begin + end, std::move(type_list));
 }
 
-std::unique_ptr<ast::ConstantsDef> Parser::parse_constants() {
+ast::Ptr<ast::ConstantsDef> Parser::parse_constants() {
   LOG_DEBUG(parser_logger, "Parsing constants definition");
   auto begin = lexer_.location();
   advance();
   auto constant_list = parse_typed_identifier_list();
   const auto &end = constant_list->location;
   LOG_DEBUG(parser_logger, "End of constants definition");
-  return std::make_unique<ast::ConstantsDef>(begin + end,
-                                             std::move(constant_list));
+  return make<ast::ConstantsDef>(begin + end, std::move(constant_list));
 }
 
-std::unique_ptr<ast::Predicate> Parser::parse_predicate() {
+ast::Ptr<ast::Predicate> Parser::parse_predicate() {
   LOG_DEBUG(parser_logger, "Parsing predicate");
   const auto begin = lexer_.location();
-  const auto &name = lexer_.get<token::Name>().name;
-  LOG_DEBUG(parser_logger, "Found predicate name \'%s\'", std::string{name}.c_str());
-  auto identifier = std::make_unique<ast::Identifier>(lexer_.location(), name);
+  const auto symbol = lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found predicate name \'%s\'",
+            std::string{symbols_->get_name(symbol)}.c_str());
+  auto identifier = make<ast::Identifier>(lexer_.location(), symbol);
   advance();
   auto parameters = parse_typed_variable_list();
   const auto &end = parameters->location;
   LOG_DEBUG(parser_logger, "End of predicate");
-  return std::make_unique<ast::Predicate>(begin + end, std::move(identifier),
-                                          std::move(parameters));
+  return make<ast::Predicate>(begin + end, std::move(identifier),
+                              std::move(parameters));
 }
 
-std::unique_ptr<ast::PredicateList> Parser::parse_predicate_list() {
+ast::Ptr<ast::PredicateList> Parser::parse_predicate_list() {
   LOG_DEBUG(parser_logger, "Parsing predicate list");
   auto begin = lexer_.location();
-  auto predicates =
-      std::make_unique<std::vector<std::unique_ptr<ast::Predicate>>>();
+  auto predicates = make_elements<ast::PredicateList>();
   while (skip_if<token::LParen>()) {
     auto predicate = parse_predicate();
     predicates->push_back(std::move(predicate));
@@ -263,43 +259,41 @@ std::unique_ptr<ast::PredicateList> Parser::parse_predicate_list() {
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of predicate list (%u element(s))",
             predicates->size());
-  return std::make_unique<ast::PredicateList>(begin + end,
-                                              std::move(predicates));
+  return make<ast::PredicateList>(begin + end, std::move(predicates));
 }
 
-std::unique_ptr<ast::PredicatesDef> Parser::parse_predicates() {
+ast::Ptr<ast::PredicatesDef> Parser::parse_predicates() {
   LOG_DEBUG(parser_logger, "Parsing predicates definition");
   const auto begin = lexer_.location();
   advance();
   auto predicate_list = parse_predicate_list();
   const auto &end = predicate_list->location;
   LOG_DEBUG(parser_logger, "End of predicates definition");
-  return std::make_unique<ast::PredicatesDef>(begin + end,
-                                              std::move(predicate_list));
+  return make<ast::PredicatesDef>(begin + end, std::move(predicate_list));
 }
 
-std::unique_ptr<ast::PredicateEvaluation> Parser::parse_predicate_evaluation() {
+ast::Ptr<ast::PredicateEvaluation> Parser::parse_predicate_evaluation() {
   LOG_DEBUG(parser_logger, "Parsing predicate evaluation");
   const auto begin = lexer_.location();
-  const auto &name = (lexer_.has_type<token::Equality>())
-                         ? "="
-                         : lexer_.get<token::Name>().name;
-  LOG_DEBUG(parser_logger, "Found predicate \'%s\'", std::string{name}.c_str());
-  auto predicate_name =
-      std::make_unique<ast::Identifier>(lexer_.location(), name);
+  const auto symbol = (lexer_.has_type<token::Equality>())
+                          ? symbols_->intern("=")
+                          : lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found predicate \'%s\'",
+            std::string{symbols_->get_name(symbol)}.c_str());
+  auto predicate_name = make<ast::Identifier>(lexer_.location(), symbol);
   advance();
   auto argument_list = parse_argument_list();
   const auto &end = argument_list->location;
   LOG_DEBUG(parser_logger, "End of predicate evaluation");
-  return std::make_unique<ast::PredicateEvaluation>(
-      begin + end, std::move(predicate_name), std::move(argument_list));
+  return make<ast::PredicateEvaluation>(begin + end, std::move(predicate_name),
+                                        std::move(argument_list));
 }
 
-std::unique_ptr<ast::Conjunction> Parser::parse_conjunction() {
+ast::Ptr<ast::Conjunction> Parser::parse_conjunction() {
   LOG_DEBUG(parser_logger, "Parsing conjunction");
   const auto begin = lexer_.location();
   advance();
-  auto arguments = std::make_unique<std::vector<ast::Condition>>();
+  auto arguments = make_elements<ast::ConditionList>();
   while (skip_if<token::LParen>()) {
     skip_comments();
     auto argument = parse_condition();
@@ -310,16 +304,16 @@ std::unique_ptr<ast::Conjunction> Parser::parse_conjunction() {
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of conjunction (%u element(s))", arguments->size());
   auto condition_list =
-      std::make_unique<ast::ConditionList>(begin + end, std::move(arguments));
-  return std::make_unique<ast::Conjunction>(condition_list->location,
-                                            std::move(condition_list));
+      make<ast::ConditionList>(begin + end, std::move(arguments));
+  return make<ast::Conjunction>(condition_list->location,
+                                std::move(condition_list));
 }
 
-std::unique_ptr<ast::Disjunction> Parser::parse_disjunction() {
+ast::Ptr<ast::Disjunction> Parser::parse_disjunction() {
   LOG_DEBUG(parser_logger, "Parsing disjunction");
   const auto begin = lexer_.location();
   advance();
-  auto arguments = std::make_unique<std::vector<ast::Condition>>();
+  auto arguments = make_elements<ast::ConditionList>();
   while (skip_if<token::LParen>()) {
     skip_comments();
     auto argument = parse_condition();
@@ -330,9 +324,9 @@ std::unique_ptr<ast::Disjunction> Parser::parse_disjunction() {
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of disjunction (%u element(s))", arguments->size());
   auto condition_list =
-      std::make_unique<ast::ConditionList>(begin + end, std::move(arguments));
-  return std::make_unique<ast::Disjunction>(condition_list->location,
-                                            std::move(condition_list));
+      make<ast::ConditionList>(begin + end, std::move(arguments));
+  return make<ast::Disjunction>(condition_list->location,
+                                std::move(condition_list));
 }
 
 ast::Condition Parser::parse_condition() {
@@ -353,7 +347,7 @@ ast::Condition Parser::parse_condition() {
     skip_comments();
     const auto &end = lexer_.location();
     LOG_DEBUG(parser_logger, "End of negation");
-    return std::make_unique<ast::Negation>(begin + end, std::move(condition));
+    return make<ast::Negation>(begin + end, std::move(condition));
   } else if (lexer_.has_type<token::Increase>() ||
              lexer_.has_type<token::Decrease>()) {
     int count = 0;
@@ -368,60 +362,41 @@ ast::Condition Parser::parse_condition() {
   } else {
     LOG_WARN(parser_logger, "Parsing empty condition");
   }
-  return std::make_unique<ast::Empty>(lexer_.location());
+  return make<ast::Empty>(lexer_.location());
 }
 
-std::unique_ptr<ast::ConditionList> Parser::parse_init_list() {
-  LOG_DEBUG(parser_logger, "Parsing init list");
+void Parser::parse_fact(bool positive, ast::Vector<ast::Fact> &facts,
+                        ast::Vector<Symbol> &arguments) {
   const auto begin = lexer_.location();
-  auto arguments = std::make_unique<std::vector<ast::Condition>>();
-  while (skip_if<token::LParen>()) {
-    skip_comments();
-    if (lexer_.has_type<token::Not>()) {
-      LOG_DEBUG(parser_logger, "Parsing negation");
-      const auto begin_negation = lexer_.location();
-      advance();
-      skip<token::LParen>();
-      skip_comments();
-      auto argument = parse_predicate_evaluation();
-      skip<token::RParen>();
-      skip_comments();
-      const auto &end = lexer_.location();
-      auto negation = std::make_unique<ast::Negation>(begin_negation + end,
-                                                      std::move(argument));
-      arguments->push_back(std::move(negation));
-      LOG_DEBUG(parser_logger, "End of negation");
-    } else if (lexer_.has_type<token::Equality>()) {
-      int count = 0;
-      while (count >= 0) {
-        advance();
-        if (lexer_.has_type<token::LParen>()) {
-          ++count;
-        } else if (lexer_.has_type<token::RParen>()) {
-          --count;
-        }
-      }
-    } else {
-      auto argument = parse_predicate_evaluation();
-      arguments->push_back(std::move(argument));
+  const auto predicate = (lexer_.has_type<token::Equality>())
+                             ? symbols_->intern("=")
+                             : lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found fact \'%s\'",
+            std::string{symbols_->get_name(predicate)}.c_str());
+  advance();
+  const auto arguments_begin = lexer_.location().begin();
+  const auto first_argument = arguments.size();
+  while (lexer_.has_type<token::Name>() || lexer_.has_type<token::Variable>()) {
+    if (lexer_.has_type<token::Variable>()) {
+      throw ParserException(lexer_.location(),
+                            "Bound arguments are only allowed within actions");
     }
-    skip<token::RParen>();
-    skip_comments();
+    arguments.push_back(lexer_.get<token::Name>().symbol);
+    lexer_.next();
   }
   const auto &end = lexer_.location();
-  LOG_DEBUG(parser_logger, "End of init list (%u element(s))", arguments->size());
-  return std::make_unique<ast::ConditionList>(begin + end,
-                                              std::move(arguments));
+  facts.push_back(ast::Fact{begin + end, arguments_begin, predicate, positive,
+                            first_argument, arguments.size() - first_argument});
 }
 
-std::unique_ptr<ast::ActionDef> Parser::parse_action() {
+ast::Ptr<ast::ActionDef> Parser::parse_action() {
   LOG_DEBUG(parser_logger, "Parsing action definition");
   const auto begin = lexer_.location();
   lexer_.next();
-  const auto &name = lexer_.get<token::Name>().name;
-  LOG_DEBUG(parser_logger, "Found action name \'%s\'", std::string{name}.c_str());
-  auto action_name =
-      std::make_unique<ast::Identifier>(lexer_.location(), std::move(name));
+  const auto symbol = lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found action name \'%s\'",
+            std::string{symbols_->get_name(symbol)}.c_str());
+  auto action_name = make<ast::Identifier>(lexer_.location(), symbol);
   advance();
   skip<token::Parameters>();
   skip_comments();
@@ -430,7 +405,7 @@ std::unique_ptr<ast::ActionDef> Parser::parse_action() {
   auto parameters = parse_typed_variable_list();
   skip<token::RParen>();
   skip_comments();
-  std::unique_ptr<ast::Precondition> precondition = nullptr;
+  ast::Ptr<ast::Precondition> precondition = nullptr;
   if (lexer_.has_type<token::Precondition>()) {
     LOG_DEBUG(parser_logger, "Parsing precondition");
     const auto precondition_begin = lexer_.location();
@@ -441,10 +416,10 @@ std::unique_ptr<ast::ActionDef> Parser::parse_action() {
     skip<token::RParen>();
     const auto end = lexer_.location();
     skip_comments();
-    precondition = std::make_unique<ast::Precondition>(precondition_begin + end,
-                                                       std::move(condition));
+    precondition =
+        make<ast::Precondition>(precondition_begin + end, std::move(condition));
   }
-  std::unique_ptr<ast::Effect> effect = nullptr;
+  ast::Ptr<ast::Effect> effect = nullptr;
   if (lexer_.has_type<token::Effect>()) {
     LOG_DEBUG(parser_logger, "Parsing effect");
     const auto effect_begin = lexer_.location();
@@ -455,37 +430,66 @@ std::unique_ptr<ast::ActionDef> Parser::parse_action() {
     skip<token::RParen>();
     const auto end = lexer_.location();
     skip_comments();
-    effect =
-        std::make_unique<ast::Effect>(effect_begin + end, std::move(condition));
+    effect = make<ast::Effect>(effect_begin + end, std::move(condition));
   }
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of action definition");
-  return std::make_unique<ast::ActionDef>(
-      begin + end, std::move(action_name), std::move(parameters),
-      std::move(precondition), std::move(effect));
+  return make<ast::ActionDef>(begin + end, std::move(action_name),
+                              std::move(parameters), std::move(precondition),
+                              std::move(effect));
 }
 
-std::unique_ptr<ast::ObjectsDef> Parser::parse_objects() {
+ast::Ptr<ast::ObjectsDef> Parser::parse_objects() {
   LOG_DEBUG(parser_logger, "Parsing objects definition");
   const auto begin = lexer_.location();
   advance();
   auto objects = parse_typed_identifier_list();
   const auto &end = objects->location;
   LOG_DEBUG(parser_logger, "End of objects definition");
-  return std::make_unique<ast::ObjectsDef>(begin + end, std::move(objects));
+  return make<ast::ObjectsDef>(begin + end, std::move(objects));
 }
 
-std::unique_ptr<ast::InitDef> Parser::parse_init() {
+// Ground atoms are stored as facts without building nodes for them
+ast::Ptr<ast::InitDef> Parser::parse_init() {
   LOG_DEBUG(parser_logger, "Parsing init definition");
   const auto begin = lexer_.location();
   advance();
-  auto init_list = parse_init_list();
+  auto facts = make<ast::Vector<ast::Fact>>(*arena_);
+  auto arguments = make<ast::Vector<Symbol>>(*arena_);
+  while (skip_if<token::LParen>()) {
+    skip_comments();
+    if (lexer_.has_type<token::Not>()) {
+      LOG_DEBUG(parser_logger, "Parsing negation");
+      advance();
+      skip<token::LParen>();
+      skip_comments();
+      parse_fact(false, *facts, *arguments);
+      skip<token::RParen>();
+      skip_comments();
+    } else if (lexer_.has_type<token::Equality>()) {
+      int count = 0;
+      while (count >= 0) {
+        advance();
+        if (lexer_.has_type<token::LParen>()) {
+          ++count;
+        } else if (lexer_.has_type<token::RParen>()) {
+          --count;
+        }
+      }
+    } else {
+      parse_fact(true, *facts, *arguments);
+    }
+    skip<token::RParen>();
+    skip_comments();
+  }
   const auto &end = lexer_.location();
-  LOG_DEBUG(parser_logger, "End of init definition");
-  return std::make_unique<ast::InitDef>(begin + end, std::move(init_list));
+  LOG_DEBUG(parser_logger, "End of init definition (%u fact(s))",
+            facts->size());
+  return make<ast::InitDef>(begin + end, std::move(facts),
+                            std::move(arguments));
 }
 
-std::unique_ptr<ast::GoalDef> Parser::parse_goal() {
+ast::Ptr<ast::GoalDef> Parser::parse_goal() {
   LOG_DEBUG(parser_logger, "Parsing goal definition");
   const auto begin = lexer_.location();
   advance();
@@ -495,11 +499,11 @@ std::unique_ptr<ast::GoalDef> Parser::parse_goal() {
   skip<token::RParen>();
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of goal definition");
-  return std::make_unique<ast::GoalDef>(begin + end, std::move(condition));
+  return make<ast::GoalDef>(begin + end, std::move(condition));
 }
 
 // TODO function support
-std::unique_ptr<ast::FunctionsDef> Parser::parse_functions() {
+ast::Ptr<ast::FunctionsDef> Parser::parse_functions() {
   LOG_WARN(parser_logger,
            "Functions will be ignored and have limited parsing support");
   LOG_DEBUG(parser_logger, "Parsing functions definition");
@@ -515,11 +519,11 @@ std::unique_ptr<ast::FunctionsDef> Parser::parse_functions() {
   }
   LOG_DEBUG(parser_logger, "End of functions definition");
   const auto &end = lexer_.location();
-  return std::make_unique<ast::FunctionsDef>(begin + end);
+  return make<ast::FunctionsDef>(begin + end);
 }
 
 // TODO metric support
-std::unique_ptr<ast::MetricDef> Parser::parse_metric() {
+ast::Ptr<ast::MetricDef> Parser::parse_metric() {
   LOG_WARN(parser_logger, "Metrics will be ignored and have limited parsing support");
   LOG_DEBUG(parser_logger, "Parsing metric definition");
   const auto begin = lexer_.location();
@@ -534,19 +538,20 @@ std::unique_ptr<ast::MetricDef> Parser::parse_metric() {
   }
   LOG_DEBUG(parser_logger, "End of metric definition");
   const auto &end = lexer_.location();
-  return std::make_unique<ast::MetricDef>(begin + end);
+  return make<ast::MetricDef>(begin + end);
 }
 
-std::unique_ptr<ast::Domain> Parser::parse_domain() {
+ast::Ptr<ast::Domain> Parser::parse_domain() {
   LOG_DEBUG(parser_logger, "Parsing domain");
   const auto begin = lexer_.location();
   skip<token::LParen>();
   skip<token::Define>();
   skip<token::LParen>();
   skip<token::Domain>();
-  const auto &name = lexer_.get<token::Name>().name;
-  LOG_DEBUG(parser_logger, "Found domain name \'%s\'", std::string{name}.c_str());
-  auto domain_name = std::make_unique<ast::Identifier>(lexer_.location(), name);
+  const auto symbol = lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found domain name \'%s\'",
+            std::string{symbols_->get_name(symbol)}.c_str());
+  auto domain_name = make<ast::Identifier>(lexer_.location(), symbol);
   lexer_.next();
   skip<token::RParen>();
   skip_comments();
@@ -554,30 +559,29 @@ std::unique_ptr<ast::Domain> Parser::parse_domain() {
   skip<token::RParen>();
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of domain");
-  return std::make_unique<ast::Domain>(begin + end, std::move(domain_name),
-                                       std::move(domain_body));
+  return make<ast::Domain>(begin + end, std::move(domain_name),
+                           std::move(domain_body));
 }
 
-std::unique_ptr<ast::Problem> Parser::parse_problem() {
+ast::Ptr<ast::Problem> Parser::parse_problem() {
   LOG_DEBUG(parser_logger, "Parsing problem");
   const auto begin = lexer_.location();
   skip<token::LParen>();
   skip<token::Define>();
   skip<token::LParen>();
   skip<token::Problem>();
-  const auto &name = lexer_.get<token::Name>().name;
-  LOG_DEBUG(parser_logger, "Found problem name \'%s\'", std::string{name}.c_str());
-  auto problem_name =
-      std::make_unique<ast::Identifier>(lexer_.location(), name);
+  const auto symbol = lexer_.get<token::Name>().symbol;
+  LOG_DEBUG(parser_logger, "Found problem name \'%s\'",
+            std::string{symbols_->get_name(symbol)}.c_str());
+  auto problem_name = make<ast::Identifier>(lexer_.location(), symbol);
   lexer_.next();
   skip<token::RParen>();
   skip<token::LParen>();
   skip<token::DomainRef>();
-  const auto &domain_ref = lexer_.get<token::Name>().name;
+  const auto domain_ref = lexer_.get<token::Name>().symbol;
   LOG_DEBUG(parser_logger, "Found domain reference \'%s\'",
-            std::string{domain_ref}.c_str());
-  auto domain_ref_name =
-      std::make_unique<ast::Identifier>(lexer_.location(), domain_ref);
+            std::string{symbols_->get_name(domain_ref)}.c_str());
+  auto domain_ref_name = make<ast::Identifier>(lexer_.location(), domain_ref);
   lexer_.next();
   skip<token::RParen>();
   skip_comments();
@@ -585,9 +589,9 @@ std::unique_ptr<ast::Problem> Parser::parse_problem() {
   skip<token::RParen>();
   const auto &end = lexer_.location();
   LOG_DEBUG(parser_logger, "End of problem");
-  return std::make_unique<ast::Problem>(begin + end, std::move(problem_name),
-                                        std::move(domain_ref_name),
-                                        std::move(problem_body));
+  return make<ast::Problem>(begin + end, std::move(problem_name),
+                            std::move(domain_ref_name),
+                            std::move(problem_body));
 }
 
 void Parser::parse_domain(ast::AST &ast) {
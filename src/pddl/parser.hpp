@@ -5,10 +5,13 @@
 #include "logging/logging.hpp"
 #include "pddl/ast/ast.hpp"
 #include "pddl/parser_exception.hpp"
+#include "pddl/symbol_table.hpp"
 #include "pddl/tokens.hpp"
+#include "util/arena.hpp"
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 extern logging::Logger parser_logger;
@@ -22,6 +25,14 @@ public:
   ast::AST parse(const std::string &domain, const std::string &problem);
 
 private:
+  template <typename T, typename... Args> ast::Ptr<T> make(Args &&...args) {
+    return ast::Ptr<T>{arena_->create<T>(std::forward<Args>(args)...)};
+  }
+
+  template <typename List> ast::Ptr<typename List::Elements> make_elements() {
+    return make<typename List::Elements>(*arena_);
+  }
+
   template <typename TokenType> void expect() {
     if (!lexer_.has_type<TokenType>()) {
       std::string msg = "Expected token \'" +
@@ -74,9 +85,9 @@ private:
     }
   }
 
-  template <bool is_domain> std::unique_ptr<ast::ElementList> parse_elements() {
+  template <bool is_domain> ast::Ptr<ast::ElementList> parse_elements() {
     const auto begin = lexer_.location();
-    auto elements = std::make_unique<std::vector<ast::Element>>();
+    auto elements = make_elements<ast::ElementList>();
     while (skip_if<token::LParen>()) {
       skip_comments();
       elements->push_back(parse_element<is_domain>());
@@ -84,44 +95,45 @@ private:
       skip_comments();
     }
     const auto &end = lexer_.location();
-    return std::make_unique<ast::ElementList>(begin + end, std::move(elements));
+    return make<ast::ElementList>(begin + end, std::move(elements));
   }
 
   void skip_comments();
   void advance();
-  std::unique_ptr<ast::IdentifierList> parse_identifier_list();
-  std::unique_ptr<ast::VariableList> parse_variable_list();
-  std::unique_ptr<ast::ArgumentList> parse_argument_list();
-  std::unique_ptr<ast::SingleTypeIdentifierList>
-  parse_single_type_identifier_list();
-  std::unique_ptr<ast::SingleTypeVariableList>
-  parse_single_type_variable_list();
-  std::unique_ptr<ast::TypedIdentifierList> parse_typed_identifier_list();
-  std::unique_ptr<ast::TypedVariableList> parse_typed_variable_list();
-  std::unique_ptr<ast::RequirementList> parse_requirement_list();
-  std::unique_ptr<ast::RequirementsDef> parse_requirements();
-  std::unique_ptr<ast::TypesDef> parse_types();
-  std::unique_ptr<ast::ConstantsDef> parse_constants();
-  std::unique_ptr<ast::Predicate> parse_predicate();
-  std::unique_ptr<ast::PredicateList> parse_predicate_list();
-  std::unique_ptr<ast::PredicatesDef> parse_predicates();
-  std::unique_ptr<ast::PredicateEvaluation> parse_predicate_evaluation();
-  std::unique_ptr<ast::Conjunction> parse_conjunction();
-  std::unique_ptr<ast::Disjunction> parse_disjunction();
+  ast::Ptr<ast::IdentifierList> parse_identifier_list();
+  ast::Ptr<ast::VariableList> parse_variable_list();
+  ast::Ptr<ast::ArgumentList> parse_argument_list();
+  ast::Ptr<ast::SingleTypeIdentifierList> parse_single_type_identifier_list();
+  ast::Ptr<ast::SingleTypeVariableList> parse_single_type_variable_list();
+  ast::Ptr<ast::TypedIdentifierList> parse_typed_identifier_list();
+  ast::Ptr<ast::TypedVariableList> parse_typed_variable_list();
+  ast::Ptr<ast::RequirementList> parse_requirement_list();
+  ast::Ptr<ast::RequirementsDef> parse_requirements();
+  ast::Ptr<ast::TypesDef> parse_types();
+  ast::Ptr<ast::ConstantsDef> parse_constants();
+  ast::Ptr<ast::Predicate> parse_predicate();
+  ast::Ptr<ast::PredicateList> parse_predicate_list();
+  ast::Ptr<ast::PredicatesDef> parse_predicates();
+  ast::Ptr<ast::PredicateEvaluation> parse_predicate_evaluation();
+  ast::Ptr<ast::Conjunction> parse_conjunction();
+  ast::Ptr<ast::Disjunction> parse_disjunction();
   ast::Condition parse_condition();
-  std::unique_ptr<ast::ConditionList> parse_init_list();
-  std::unique_ptr<ast::ActionDef> parse_action();
-  std::unique_ptr<ast::ObjectsDef> parse_objects();
-  std::unique_ptr<ast::InitDef> parse_init();
-  std::unique_ptr<ast::GoalDef> parse_goal();
-  std::unique_ptr<ast::FunctionsDef> parse_functions();
-  std::unique_ptr<ast::MetricDef> parse_metric();
-  std::unique_ptr<ast::Domain> parse_domain();
-  std::unique_ptr<ast::Problem> parse_problem();
+  ast::Ptr<ast::ActionDef> parse_action();
+  ast::Ptr<ast::ObjectsDef> parse_objects();
+  void parse_fact(bool positive, ast::Vector<ast::Fact> &facts,
+                  ast::Vector<Symbol> &arguments);
+  ast::Ptr<ast::InitDef> parse_init();
+  ast::Ptr<ast::GoalDef> parse_goal();
+  ast::Ptr<ast::FunctionsDef> parse_functions();
+  ast::Ptr<ast::MetricDef> parse_metric();
+  ast::Ptr<ast::Domain> parse_domain();
+  ast::Ptr<ast::Problem> parse_problem();
   void parse_domain(ast::AST &ast);
   void parse_problem(ast::AST &ast);
 
   Lexer lexer_;
+  SymbolTable *symbols_ = nullptr;
+  util::Arena *arena_ = nullptr;
 };
 
 } // namespace pddl
@@ -0,0 +1,42 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include "util/index.hpp"
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pddl {
+
+class SymbolTable;
+
+using Symbol = util::Index<SymbolTable>;
+
+// Interns identifiers such that equal names get the same dense symbol. The
+// names are views into the input, which has to outlive the table.
+class SymbolTable {
+public:
+  Symbol intern(std::string_view name) {
+    auto [it, inserted] = symbols_.try_emplace(name, names_.size());
+    if (inserted) {
+      names_.push_back(name);
+    }
+    return it->second;
+  }
+
+  std::string_view get_name(Symbol symbol) const noexcept {
+    return names_[symbol];
+  }
+
+  size_t size() const noexcept { return names_.size(); }
+
+private:
+  std::unordered_map<std::string_view, Symbol> symbols_;
+  std::vector<std::string_view> names_;
+};
+
+} // namespace pddl
+
+#endif /* end of include guard: SYMBOL_TABLE_HPP */
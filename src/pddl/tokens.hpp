@@ -3,6 +3,7 @@
 
 #include "lexer/rules.hpp"
 #include "lexer/token_set.hpp"
+#include "pddl/symbol_table.hpp"
 
 #include <cassert>
 #include <string_view>
@@ -136,16 +137,19 @@ struct Name
                                 lexer::rule::Literal<'_'>>>> {
   static constexpr auto printable_name = "<name>";
   std::string_view name;
+  Symbol symbol;
 };
 
 struct Requirement : lexer::rule::Sequence<lexer::rule::Literal<':'>, Name> {
   static constexpr auto printable_name = "<requirement>";
   std::string_view name;
+  Symbol symbol;
 };
 
 struct Variable : lexer::rule::Sequence<lexer::rule::Literal<'?'>, Name> {
   static constexpr auto printable_name = "<variable>";
   std::string_view name;
+  Symbol symbol;
 };
 
 struct Number
@@ -163,19 +167,24 @@ struct Comment : lexer::rule::Sequence<lexer::rule::Literal<';'>,
   std::string_view content;
 };
 
+// Interns names into the symbol table
 struct TokenAction {
-  static void apply(char *begin, char *end, Requirement &r) noexcept {
+  void apply(const char *begin, const char *end, Requirement &r) {
     r.name = {begin, static_cast<size_t>(end - begin)};
+    r.symbol = symbols->intern(r.name);
   }
-  static void apply(char *begin, char *end, Name &n) noexcept {
+
+  void apply(const char *begin, const char *end, Name &n) {
     n.name = {begin, static_cast<size_t>(end - begin)};
+    n.symbol = symbols->intern(n.name);
   }
 
-  static void apply(char *begin, char *end, Variable &v) noexcept {
+  void apply(const char *begin, const char *end, Variable &v) {
     v.name = {begin, static_cast<size_t>(end - begin)};
+    v.symbol = symbols->intern(v.name);
   }
 
-  static void apply(char *begin, char *end, Number &n) noexcept {
+  static void apply(const char *begin, const char *end, Number &n) noexcept {
     n.value = 0;
     int factor = 1;
     --end;
@@ -191,9 +200,11 @@ struct TokenAction {
     }
   }
 
-  static void apply(char *begin, char *end, Comment &c) noexcept {
+  static void apply(const char *begin, const char *end, Comment &c) noexcept {
     c.content = {begin, static_cast<size_t>(end - begin)};
   }
+
+  SymbolTable *symbols = nullptr;
 };
 
 struct TokenSet
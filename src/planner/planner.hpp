@@ -7,11 +7,16 @@
 #include "util/timer.hpp"
 
 #include <cassert>
+#include <exception>
 #include <utility>
 #include <vector>
 
 extern logging::Logger planner_logger;
 
+struct UnsolvableException : std::exception {
+  inline const char *what() const noexcept override { return "unsolvable"; }
+};
+
 class Planner {
 public:
   Plan find_plan(const std::shared_ptr<normalized::Problem> &problem,
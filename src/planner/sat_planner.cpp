@@ -34,8 +34,8 @@ Plan SatPlanner::find_plan_impl(
   sat::IpasirSolver solver;
   solver << static_cast<int>(Encoder::SAT) << 0;
   solver << -static_cast<int>(Encoder::UNSAT) << 0;
-  add_formula(solver, encoder_->get_init(), 0, *encoder_);
-  add_formula(solver, encoder_->get_universal_clauses(), 0, *encoder_);
+  add_formula(solver, encoder_->get_init_template(), 0);
+  add_formula(solver, encoder_->get_universal_template(), 0);
 
   unsigned int step = 0;
   unsigned int skipped_steps = 0;
@@ -52,9 +52,9 @@ Plan SatPlanner::find_plan_impl(
     }
 #endif
     do {
-      add_formula(solver, encoder_->get_transition_clauses(), step, *encoder_);
+      add_formula(solver, encoder_->get_transition_template(), step);
       ++step;
-      add_formula(solver, encoder_->get_universal_clauses(), step, *encoder_);
+      add_formula(solver, encoder_->get_universal_template(), step);
     } while (step < static_cast<unsigned int>(current_step));
 
     assume_goal(solver, step, *encoder_);
@@ -96,21 +96,18 @@ Plan SatPlanner::find_plan_impl(
 }
 
 void SatPlanner::add_formula(sat::Solver &solver,
-                             const Encoder::Formula &formula, unsigned int step,
-                             const Encoder &encoder) const noexcept {
-  for (const auto &clause : formula.clauses) {
-    for (const auto &literal : clause.literals) {
-      solver << encoder.to_sat_var(literal, step);
-    }
-    solver << 0;
-  }
+                             const Encoder::ClauseTemplate &clause_template,
+                             unsigned int step) noexcept {
+  clause_template.instantiate(step, step_clauses_);
+  solver.add_clauses(step_clauses_);
 }
 
 void SatPlanner::assume_goal(sat::Solver &solver, unsigned int step,
-                             const Encoder &encoder) const noexcept {
-  for (const auto &clause : encoder.get_goal_clauses().clauses) {
-    for (const auto &literal : clause.literals) {
-      solver.assume(encoder.to_sat_var(literal, step));
+                             const Encoder &encoder) noexcept {
+  encoder.get_goal_template().instantiate(step, step_clauses_);
+  for (auto l : step_clauses_) {
+    if (l != 0) {
+      solver.assume(l);
     }
   }
 }
@@ -9,19 +9,23 @@
 #include "util/timer.hpp"
 
 #include <memory>
+#include <vector>
 
 extern Config config;
 
 class SatPlanner final : public Planner {
   std::unique_ptr<Encoder> encoder_;
+  // Buffer for the instantiated clauses of a single step
+  std::vector<int> step_clauses_;
 
   Plan find_plan_impl(const std::shared_ptr<normalized::Problem> &problem,
                       util::Seconds timeout) override;
 
-  void add_formula(sat::Solver &solver, const Encoder::Formula &formula,
-                   unsigned int step, const Encoder &encoder) const noexcept;
+  void add_formula(sat::Solver &solver,
+                   const Encoder::ClauseTemplate &clause_template,
+                   unsigned int step) noexcept;
   void assume_goal(sat::Solver &solver, unsigned int step,
-                   const Encoder &encoder) const noexcept;
+                   const Encoder &encoder) noexcept;
 
 public:
   void set_encoder(std::unique_ptr<Encoder> encoder) noexcept;
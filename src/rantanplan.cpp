@@ -7,6 +7,7 @@
 #include "lexer/lexer.hpp"
 #include "logging/logging.hpp"
 #include "model/normalize.hpp"
+#include "model/serialize.hpp"
 #include "model/to_string.hpp"
 #include "options/options.hpp"
 #include "pddl/ast/ast.hpp"
@@ -69,6 +70,33 @@ void print_version() noexcept {
              DEBUG_MODE ? "debug build " : "", hostname);
 }
 
+// Returns nullptr after printing the error if the pddl files are invalid
+std::unique_ptr<parsed::Problem> parse_problem() {
+  pddl::Parser parser;
+  try {
+    auto ast = parser.parse(config.domain_file, config.problem_file);
+    pddl::ModelBuilder builder;
+    return builder.parse(ast);
+  } catch (const pddl::ParserException &e) {
+    std::stringstream ss;
+    if (e.location()) {
+      ss << *e.location();
+      ss << ": ";
+    }
+    ss << e.what();
+    PRINT_ERROR(ss.str().c_str());
+  } catch (const lexer::LexerException &e) {
+    std::stringstream ss;
+    if (e.location()) {
+      ss << *e.location();
+      ss << ": ";
+    }
+    ss << e.what();
+    PRINT_ERROR(ss.str().c_str());
+  }
+  return nullptr;
+}
+
 int main(int argc, char *argv[]) {
   std::atexit(print_memory_usage);
 
@@ -116,57 +144,46 @@ int main(int argc, char *argv[]) {
 
   print_version();
 
-  std::unique_ptr<parsed::Problem> parsed_problem;
+  std::shared_ptr<normalized::Problem> problem;
 
-  LOG_INFO(main_logger, "Reading problem...");
-
-  pddl::Parser parser;
-
-  try {
-    auto ast = parser.parse(config.domain_file, config.problem_file);
-    pddl::ModelBuilder builder;
-    parsed_problem = builder.parse(ast);
-  } catch (const pddl::ParserException &e) {
-    std::stringstream ss;
-    if (e.location()) {
-      ss << *e.location();
-      ss << ": ";
-    }
-    ss << e.what();
-    PRINT_ERROR(ss.str().c_str());
-    return 1;
-  } catch (const lexer::LexerException &e) {
-    std::stringstream ss;
-    if (e.location()) {
-      ss << *e.location();
-      ss << ": ";
+  if (config.load_file) {
+    LOG_INFO(main_logger, "Loading normalized problem...");
+    try {
+      problem = load_problem(*config.load_file);
+    } catch (const SerializeException &e) {
+      PRINT_ERROR(e.what());
+      return 1;
     }
-    ss << e.what();
-    PRINT_ERROR(ss.str().c_str());
-    return 1;
-  }
+  } else {
+    LOG_INFO(main_logger, "Reading problem...");
 
-  LOG_INFO(main_logger,
-           "The parsed problem has %lu types, %lu constants, %lu predicates, "
-           "%lu actions",
-           parsed_problem->get_types().size(),
-           parsed_problem->get_constants().size(),
-           parsed_problem->get_predicates().size(),
-           parsed_problem->get_actions().size());
+    auto parsed_problem = parse_problem();
+    if (!parsed_problem) {
+      return 1;
+    }
 
-  if (config.planning_mode == Config::PlanningMode::Parse) {
-    LOG_INFO(main_logger, "Finished");
-    return 0;
-  }
+    LOG_INFO(main_logger,
+             "The parsed problem has %lu types, %lu constants, %lu "
+             "predicates, %lu actions",
+             parsed_problem->get_types().size(),
+             parsed_problem->get_constants().size(),
+             parsed_problem->get_predicates().size(),
+             parsed_problem->get_actions().size());
+
+    if (config.planning_mode == Config::PlanningMode::Parse) {
+      LOG_INFO(main_logger, "Finished");
+      return 0;
+    }
 
-  LOG_INFO(main_logger, "Normalizing...");
+    LOG_INFO(main_logger, "Normalizing...");
 
-  auto problem = normalize(*parsed_problem);
+    problem = normalize(*parsed_problem);
 
-  if (!problem) {
-    LOG_INFO(main_logger, "Problem unsolvable");
-    LOG_INFO(main_logger, "Finished");
-    return 2;
+    if (!problem) {
+      LOG_INFO(main_logger, "Problem unsolvable");
+      LOG_INFO(main_logger, "Finished");
+      return 2;
+    }
   }
 
   LOG_DEBUG(main_logger, "Normalized problem:\n%s",
@@ -175,7 +192,20 @@ int main(int argc, char *argv[]) {
   LOG_INFO(main_logger, "Normalizing resulted in %lu actions",
            problem->actions.size());
 
-  if (config.planning_mode == Config::PlanningMode::Normalize) {
+  if (config.dump_file) {
+    try {
+      dump_problem(*problem, *config.dump_file);
+    } catch (const SerializeException &e) {
+      PRINT_ERROR(e.what());
+      return 1;
+    }
+    LOG_INFO(main_logger, "Dumped normalized problem to %s",
+             config.dump_file->c_str());
+  }
+
+  // A loaded problem has already been parsed
+  if (config.planning_mode == Config::PlanningMode::Parse ||
+      config.planning_mode == Config::PlanningMode::Normalize) {
     LOG_INFO(main_logger, "Finished");
     return 0;
   }
@@ -212,6 +242,27 @@ int main(int argc, char *argv[]) {
              "Parameter cannot imply actions in the sequential encoding.");
   }
 
+  if (config.parameter_encoding != Config::ParameterEncoding::Direct) {
+    if (config.encoding == Config::Encoding::Sequential) {
+      LOG_WARN(main_logger, "The sequential encoding only supports the direct "
+                            "parameter encoding.");
+      config.parameter_encoding = Config::ParameterEncoding::Direct;
+    }
+    if (config.parameter_implies_action) {
+      LOG_WARN(main_logger, "Parameters cannot imply actions with a binary or "
+                            "order parameter encoding.");
+      config.parameter_implies_action = false;
+    }
+  }
+
+  if (config.encoding_cache &&
+      config.planning_mode != Config::PlanningMode::Fixed &&
+      config.planning_mode != Config::PlanningMode::Oneshot) {
+    LOG_WARN(main_logger, "The encoding cache is only used in the fixed and "
+                          "oneshot planning modes.");
+    config.encoding_cache = std::nullopt;
+  }
+
   std::unique_ptr<Engine> engine;
 
   if (config.planning_mode == Config::PlanningMode::Fixed) {
@@ -241,6 +292,9 @@ int main(int argc, char *argv[]) {
   } catch (const TimeoutException &e) {
     LOG_ERROR(main_logger, "Search timed out");
     return 1;
+  } catch (const UnsolvableException &e) {
+    LOG_ERROR(main_logger, "Problem is unsolvable");
+    return 1;
   }
 
   return 0;
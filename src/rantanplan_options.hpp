@@ -23,6 +23,11 @@ inline options::Options set_options(const std::string &name) {
                             "Global planner timeout in seconds");
   options.add_option<std::string>({"plan-file", 'o'},
                                   "File to output the plan to");
+  options.add_option<std::string>({"dump-problem", 'n'},
+                                  "File to dump the normalized problem to");
+  options.add_option<std::string>(
+      {"load-problem", 'i'},
+      "Normalized problem file to load instead of the pddl files");
 
   // Grounding
   options.add_option<std::string>({"parameter-selection", 's'},
@@ -39,8 +44,14 @@ inline options::Options set_options(const std::string &name) {
 
   // Encoding
   options.add_option<std::string>({"encoding", 'e'}, "Encoding to use");
+  options.add_option<std::string>({"parameter-encoding", 'p'},
+                                  "Encoding of action parameters");
   options.add_option<bool>({"imply-action", 'y'}, "Parameters imply actions");
   options.add_option<unsigned int>({"dnf-threshold", 'd'}, "DNF threshold");
+  options.add_option<std::string>({"at-most-one", 'a'},
+                                  "At-most-one encoding to use");
+  options.add_option<std::string>({"encoding-cache", 'b'},
+                                  "Directory for caching encodings");
 
   // Planning
   options.add_option<float>({"step-factor", 'f'}, "Step factor");
@@ -54,6 +65,10 @@ inline options::Options set_options(const std::string &name) {
 #ifdef PARALLEL
   // Parallel
   options.add_option<unsigned int>({"num-threads", 'j'}, "Number of threads");
+  options.add_option<unsigned int>({"encoding-threads", 'x'},
+                                   "Number of threads per encoder");
+  options.add_option<unsigned int>({"cache-shards", 'q'},
+                                   "Number of shards per grounding cache");
 #endif
 
   // Logging
@@ -63,17 +78,21 @@ inline options::Options set_options(const std::string &name) {
 }
 
 inline void set_config(const options::Options &options, Config &config) {
+  if (const auto &o = options.get<std::string>("load-problem"); o.count > 0) {
+    config.load_file = o.value;
+  }
+
   if (const auto &domain = options.get<std::string>("domain");
       domain.count > 0) {
     config.domain_file = domain.value;
-  } else {
+  } else if (!config.load_file) {
     throw ConfigException{"Domain file required"};
   }
 
   if (const auto &problem = options.get<std::string>("problem");
       problem.count > 0) {
     config.problem_file = problem.value;
-  } else {
+  } else if (!config.load_file) {
     throw ConfigException{"Problem file required"};
   }
 
@@ -93,6 +112,11 @@ inline void set_config(const options::Options &options, Config &config) {
     config.plan_file = o.value;
   }
 
+  if (const auto &o = options.get<std::string>("dump-problem");
+      o.count > 0) {
+    config.dump_file = o.value;
+  }
+
   if (const auto &o = options.get<std::string>("parameter-selection");
       o.count > 0) {
     config.parse_parameter_selection(o.value);
@@ -134,12 +158,26 @@ inline void set_config(const options::Options &options, Config &config) {
     config.parse_encoding(o.value);
   }
 
+  if (const auto &o = options.get<std::string>("parameter-encoding");
+      o.count > 0) {
+    config.parse_parameter_encoding(o.value);
+  }
+
   config.parameter_implies_action = options.get<bool>("imply-action").count > 0;
 
   if (const auto &o = options.get<unsigned int>("dnf-threshold"); o.count > 0) {
     config.dnf_threshold = o.value;
   }
 
+  if (const auto &o = options.get<std::string>("at-most-one"); o.count > 0) {
+    config.parse_at_most_one_encoding(o.value);
+  }
+
+  if (const auto &o = options.get<std::string>("encoding-cache");
+      o.count > 0) {
+    config.encoding_cache = o.value;
+  }
+
   if (const auto &o = options.get<float>("step-factor"); o.count > 0) {
     if (o.value < 1.0f) {
       LOG_WARN(main_logger, "Step factor should be at least 1.0");
@@ -176,6 +214,21 @@ inline void set_config(const options::Options &options, Config &config) {
     }
     config.num_threads = std::max(o.value, 1u);
   }
+
+  if (const auto &o = options.get<unsigned int>("encoding-threads");
+      o.count > 0) {
+    if (o.value < 1) {
+      LOG_WARN(main_logger, "Number of encoding threads should be at least 1");
+    }
+    config.encoding_threads = std::max(o.value, 1u);
+  }
+
+  if (const auto &o = options.get<unsigned int>("cache-shards"); o.count > 0) {
+    if (o.value < 1) {
+      LOG_WARN(main_logger, "Number of cache shards should be at least 1");
+    }
+    config.cache_shards = std::max(o.value, 1u);
+  }
 #endif
 
   if (options.get<bool>("debug-log").count > 0) {
@@ -0,0 +1,93 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Bump allocator that frees all of its memory at once when it is destroyed.
+// Objects created in the arena are never destroyed, so they must not own
+// memory outside of it.
+class Arena {
+public:
+  static constexpr size_t block_size = 1 << 16;
+
+  Arena() = default;
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  void *allocate(size_t size, size_t alignment) {
+    // Large allocations get a block of their own so that the current block
+    // keeps its remaining space
+    if (size > block_size / 4) {
+      blocks_.emplace_back(new std::byte[size + alignment]);
+      void *pointer = blocks_.back().get();
+      auto space = size + alignment;
+      return std::align(alignment, size, pointer, space);
+    }
+    void *pointer = current_;
+    auto space = static_cast<size_t>(end_ - current_);
+    if (current_ == nullptr ||
+        std::align(alignment, size, pointer, space) == nullptr) {
+      blocks_.emplace_back(new std::byte[block_size]);
+      current_ = blocks_.back().get();
+      end_ = current_ + block_size;
+      pointer = current_;
+      space = block_size;
+      std::align(alignment, size, pointer, space);
+    }
+    current_ = static_cast<std::byte *>(pointer) + size;
+    return pointer;
+  }
+
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    return new (allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+private:
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  std::byte *current_ = nullptr;
+  std::byte *end_ = nullptr;
+};
+
+// Allocator for standard containers in an arena. Deallocation is a no-op.
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  ArenaAllocator(Arena &arena) noexcept : arena_{&arena} {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) noexcept
+      : arena_{other.arena_} {}
+
+  T *allocate(size_t n) {
+    return static_cast<T *>(arena_->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *, size_t) noexcept {}
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &other) const noexcept {
+    return arena_ == other.arena_;
+  }
+
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U> &other) const noexcept {
+    return arena_ != other.arena_;
+  }
+
+private:
+  template <typename> friend class ArenaAllocator;
+
+  Arena *arena_;
+};
+
+} // namespace util
+
+#endif /* end of include guard: ARENA_HPP */
@@ -0,0 +1,115 @@
+#ifndef BLOCK_VECTOR_HPP
+#define BLOCK_VECTOR_HPP
+
+#include "util/shared_vector.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Immutable vector concatenated from SharedVector blocks, so that vectors
+// built from the same blocks share their elements. Copying only copies one
+// pointer per block and element.
+template <typename T> class BlockVector {
+public:
+  using value_type = T;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T *;
+    using reference = const T &;
+
+    const_iterator() = default;
+
+    explicit const_iterator(
+        typename std::vector<const T *>::const_iterator it) noexcept
+        : it_{it} {}
+
+    inline const T &operator*() const noexcept { return **it_; }
+    inline const T *operator->() const noexcept { return *it_; }
+
+    inline const_iterator &operator++() noexcept {
+      ++it_;
+      return *this;
+    }
+
+    inline const_iterator operator++(int) noexcept {
+      auto old = *this;
+      ++it_;
+      return old;
+    }
+
+    inline bool operator==(const const_iterator &other) const noexcept {
+      return it_ == other.it_;
+    }
+
+    inline bool operator!=(const const_iterator &other) const noexcept {
+      return it_ != other.it_;
+    }
+
+  private:
+    typename std::vector<const T *>::const_iterator it_;
+  };
+
+  using iterator = const_iterator;
+
+  BlockVector() = default;
+
+  BlockVector(std::vector<T> data) { append(std::move(data)); }
+
+  BlockVector &operator=(std::vector<T> data) {
+    blocks_.clear();
+    elements_.clear();
+    append(std::move(data));
+    return *this;
+  }
+
+  void append(SharedVector<T> block) {
+    elements_.reserve(elements_.size() + block.size());
+    for (const auto &element : block) {
+      elements_.push_back(&element);
+    }
+    blocks_.push_back(std::move(block));
+  }
+
+  // Position of an element of this vector
+  size_t index_of(const T *element) const noexcept {
+    size_t offset = 0;
+    for (const auto &block : blocks_) {
+      if (!block.empty() &&
+          !std::less<const T *>{}(element, &block.front()) &&
+          !std::less<const T *>{}(&block.back(), element)) {
+        return offset + static_cast<size_t>(element - &block.front());
+      }
+      offset += block.size();
+    }
+    return offset;
+  }
+
+  inline const T &operator[](size_t i) const noexcept { return *elements_[i]; }
+  inline const T &front() const noexcept { return *elements_.front(); }
+  inline const T &back() const noexcept { return *elements_.back(); }
+  inline size_t size() const noexcept { return elements_.size(); }
+  inline bool empty() const noexcept { return elements_.empty(); }
+  inline const_iterator begin() const noexcept {
+    return const_iterator{elements_.begin()};
+  }
+  inline const_iterator end() const noexcept {
+    return const_iterator{elements_.end()};
+  }
+
+private:
+  std::vector<SharedVector<T>> blocks_;
+  std::vector<const T *> elements_;
+};
+
+} // namespace util
+
+#endif /* end of include guard: BLOCK_VECTOR_HPP */
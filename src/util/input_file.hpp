@@ -0,0 +1,54 @@
+#ifndef INPUT_FILE_HPP
+#define INPUT_FILE_HPP
+
+#include "util/mapped_file.hpp"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace util {
+
+// Contents of an input file that is read once from front to back. Regular
+// files are mapped, anything else such as a pipe is read into a buffer.
+class InputFile {
+public:
+  explicit InputFile(const std::string &path) : mapped_{path} {
+    if (mapped_.is_open()) {
+      mapped_.advise(MADV_SEQUENTIAL);
+      return;
+    }
+    std::ifstream in{path, std::ios::binary};
+    if (!in.is_open()) {
+      return;
+    }
+    char chunk[1 << 16];
+    while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0) {
+      buffer_.append(chunk, static_cast<size_t>(in.gcount()));
+    }
+    is_buffered_ = true;
+  }
+
+  inline bool is_open() const noexcept {
+    return mapped_.is_open() || is_buffered_;
+  }
+
+  inline const char *data() const noexcept {
+    return is_buffered_ ? buffer_.data() : mapped_.data();
+  }
+
+  inline size_t size() const noexcept {
+    return is_buffered_ ? buffer_.size() : mapped_.size();
+  }
+
+private:
+  MappedFile mapped_;
+  std::string buffer_;
+  bool is_buffered_ = false;
+};
+
+} // namespace util
+
+#endif /* end of include guard: INPUT_FILE_HPP */
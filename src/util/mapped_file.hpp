@@ -0,0 +1,76 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace util {
+
+// Read-only memory mapping of a whole regular file. Like std::ifstream,
+// opening failures are reported by is_open() instead of exceptions. Other
+// files such as pipes cannot be mapped and are never open.
+class MappedFile {
+public:
+  explicit MappedFile(const std::string &path) noexcept {
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat file_stat;
+    if (::fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+        file_stat.st_size >= 0) {
+      size_ = static_cast<size_t>(file_stat.st_size);
+      if (size_ == 0) {
+        is_open_ = true;
+      } else {
+        auto data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+          data_ = static_cast<const char *>(data);
+          is_open_ = true;
+        }
+      }
+    }
+    ::close(fd);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other) noexcept
+      : data_{other.data_}, size_{other.size_}, is_open_{other.is_open_} {
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.is_open_ = false;
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char *>(data_), size_);
+    }
+  }
+
+  // Hint for the expected access pattern, e.g. MADV_SEQUENTIAL
+  void advise(int advice) const noexcept {
+    if (data_ != nullptr) {
+      ::madvise(const_cast<char *>(data_), size_, advice);
+    }
+  }
+
+  inline bool is_open() const noexcept { return is_open_; }
+  inline const char *data() const noexcept { return data_; }
+  inline size_t size() const noexcept { return size_; }
+
+private:
+  const char *data_ = nullptr;
+  size_t size_ = 0;
+  bool is_open_ = false;
+};
+
+} // namespace util
+
+#endif /* end of include guard: MAPPED_FILE_HPP */
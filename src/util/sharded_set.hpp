@@ -0,0 +1,64 @@
+#ifndef SHARDED_SET_HPP
+#define SHARDED_SET_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace util {
+
+// Hash set for concurrent use. The elements are distributed over shards by
+// their hash, each guarded by its own mutex, so that threads only contend
+// when accessing the same shard. A single shard is a set behind one mutex.
+template <typename T> class ShardedSet {
+public:
+  explicit ShardedSet(size_t num_shards = 1)
+      : shards_(std::max(num_shards, size_t{1})) {}
+
+  bool contains(const T &value) const {
+    auto &shard = get_shard(value);
+    std::lock_guard l{shard.mutex};
+    return shard.set.find(value) != shard.set.end();
+  }
+
+  void insert(const T &value) {
+    auto &shard = get_shard(value);
+    std::lock_guard l{shard.mutex};
+    if (shard.set.insert(value).second) {
+      size_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void clear() {
+    for (auto &shard : shards_) {
+      std::lock_guard l{shard.mutex};
+      shard.set.clear();
+    }
+    size_.store(0, std::memory_order_relaxed);
+  }
+
+  // Exact only if no thread modifies the set
+  size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+private:
+  // Each shard on its own cache line to avoid false sharing of the mutexes
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    std::unordered_set<T> set;
+  };
+
+  Shard &get_shard(const T &value) const {
+    return shards_[std::hash<T>{}(value) % shards_.size()];
+  }
+
+  mutable std::vector<Shard> shards_;
+  std::atomic_size_t size_ = 0;
+};
+
+} // namespace util
+
+#endif /* end of include guard: SHARDED_SET_HPP */
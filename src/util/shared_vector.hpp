@@ -0,0 +1,51 @@
+#ifndef SHARED_VECTOR_HPP
+#define SHARED_VECTOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Immutable vector whose elements are shared between all copies, so that
+// copying only copies a pointer. Modifying means assigning a new vector.
+template <typename T> class SharedVector {
+public:
+  using value_type = T;
+  using const_iterator = typename std::vector<T>::const_iterator;
+  using iterator = const_iterator;
+
+  SharedVector() = default;
+
+  SharedVector(std::vector<T> data)
+      : data_{std::make_shared<const std::vector<T>>(std::move(data))} {}
+
+  explicit SharedVector(std::shared_ptr<const std::vector<T>> data) noexcept
+      : data_{std::move(data)} {}
+
+  SharedVector &operator=(std::vector<T> data) {
+    data_ = std::make_shared<const std::vector<T>>(std::move(data));
+    return *this;
+  }
+
+  inline const std::vector<T> &get() const noexcept {
+    static const std::vector<T> empty;
+    return data_ ? *data_ : empty;
+  }
+
+  inline const T &operator[](size_t i) const noexcept { return get()[i]; }
+  inline const T &front() const noexcept { return get().front(); }
+  inline const T &back() const noexcept { return get().back(); }
+  inline size_t size() const noexcept { return get().size(); }
+  inline bool empty() const noexcept { return get().empty(); }
+  inline const_iterator begin() const noexcept { return get().begin(); }
+  inline const_iterator end() const noexcept { return get().end(); }
+
+private:
+  std::shared_ptr<const std::vector<T>> data_;
+};
+
+} // namespace util
+
+#endif /* end of include guard: SHARED_VECTOR_HPP */
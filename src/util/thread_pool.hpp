@@ -0,0 +1,172 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace util {
+
+// Persistent worker threads executing batches of indexed tasks. The tasks of
+// a batch are split into contiguous ranges, one per worker. A worker without
+// remaining tasks steals the upper half of the range of another worker.
+// Batches submitted concurrently from several threads run one after another.
+class ThreadPool {
+public:
+  explicit ThreadPool(unsigned int num_threads)
+      : ranges_(std::max(num_threads, 1u)) {
+    workers_.reserve(ranges_.size());
+    for (unsigned int thread = 0; thread < ranges_.size(); ++thread) {
+      workers_.emplace_back([this, thread]() { work(thread); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard l{mutex_};
+      stop_ = true;
+    }
+    start_.notify_all();
+    std::for_each(workers_.begin(), workers_.end(), [](auto &t) { t.join(); });
+  }
+
+  inline unsigned int get_num_threads() const noexcept {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+  // Calls f(task, thread) for each task in [0, num_tasks) on at most
+  // num_threads workers and blocks until all tasks are done. If f throws, the
+  // remaining tasks are dropped and the first exception is rethrown.
+  template <typename F>
+  void run(size_t num_tasks, unsigned int num_threads, F &&f) {
+    if (num_tasks == 0) {
+      return;
+    }
+    std::lock_guard batch_lock{batch_mutex_};
+    std::unique_lock l{mutex_};
+    num_active_ = std::clamp(num_threads, 1u, get_num_threads());
+    for (size_t thread = 0; thread < ranges_.size(); ++thread) {
+      std::lock_guard range_lock{ranges_[thread].mutex};
+      if (thread < num_active_) {
+        ranges_[thread].begin = num_tasks * thread / num_active_;
+        ranges_[thread].end = num_tasks * (thread + 1) / num_active_;
+      } else {
+        ranges_[thread].begin = ranges_[thread].end = 0;
+      }
+    }
+    task_ = [&f](size_t task, unsigned int thread) { f(task, thread); };
+    exception_ = nullptr;
+    num_running_ = get_num_threads();
+    ++batch_;
+    start_.notify_all();
+    done_.wait(l, [this]() { return num_running_ == 0; });
+    task_ = nullptr;
+    if (exception_) {
+      std::rethrow_exception(std::exchange(exception_, nullptr));
+    }
+  }
+
+private:
+  struct Range {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  void work(unsigned int thread) {
+    uint_fast64_t batch = 0;
+    while (true) {
+      {
+        std::unique_lock l{mutex_};
+        start_.wait(l, [&]() { return stop_ || batch_ != batch; });
+        if (stop_) {
+          return;
+        }
+        batch = batch_;
+      }
+      size_t task;
+      while (thread < num_active_ && next_task(thread, task)) {
+        try {
+          task_(task, thread);
+        } catch (...) {
+          {
+            std::lock_guard l{mutex_};
+            if (!exception_) {
+              exception_ = std::current_exception();
+            }
+          }
+          for (auto &range : ranges_) {
+            std::lock_guard range_lock{range.mutex};
+            range.begin = range.end;
+          }
+        }
+      }
+      std::lock_guard l{mutex_};
+      if (--num_running_ == 0) {
+        done_.notify_one();
+      }
+    }
+  }
+
+  bool next_task(unsigned int thread, size_t &task) {
+    auto &own = ranges_[thread];
+    {
+      std::lock_guard l{own.mutex};
+      if (own.begin < own.end) {
+        task = own.begin++;
+        return true;
+      }
+    }
+    for (unsigned int i = 1; i < num_active_; ++i) {
+      auto &victim = ranges_[(thread + i) % num_active_];
+      size_t begin;
+      size_t end;
+      {
+        std::lock_guard l{victim.mutex};
+        if (victim.begin >= victim.end) {
+          continue;
+        }
+        end = victim.end;
+        begin = victim.begin + (victim.end - victim.begin) / 2;
+        if (begin == victim.begin) {
+          task = victim.begin++;
+          return true;
+        }
+        victim.end = begin;
+      }
+      std::lock_guard l{own.mutex};
+      own.begin = begin + 1;
+      own.end = end;
+      task = begin;
+      return true;
+    }
+    return false;
+  }
+
+  std::vector<Range> ranges_;
+  std::vector<std::thread> workers_;
+  std::function<void(size_t, unsigned int)> task_;
+  std::exception_ptr exception_;
+  std::mutex batch_mutex_;
+  std::mutex mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  uint_fast64_t batch_ = 0;
+  unsigned int num_active_ = 0;
+  unsigned int num_running_ = 0;
+  bool stop_ = false;
+};
+
+} // namespace util
+
+#endif /* end of include guard: THREAD_POOL_HPP */